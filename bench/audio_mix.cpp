@@ -0,0 +1,106 @@
+﻿#include "xx2d.h"
+
+// offline mix benchmark ( AudioModes::Offline: no device, no real time clock. run anywhere, e.g. ci ). run at repo root ( res/1.ogg )
+// 1. mix cost of 8 ~ 256 busy voices: wall secs spent by Mix per 1 sec of audio. re-trigger all voices every 10 blocks: cost grows with voices only
+// 2. trigger to first sample: Play -> audio thread bind & start voice -> first non silent frame of the next Mix
+// 3. streamed bg music ( PlayBG: MA_SOUND_FLAG_STREAM, res/bg.ogg ): wall secs spent by Mix per 1 minute of audio ( decode cost, not whole file up front )
+//    and memory ( GetBGMemorySize: vfs file bytes + pcm pages ) sampled every 10 audio secs, peak reported
+// exit code 1 when playing voices exceed numVoices or bg music mix nothing but silence
+
+#ifdef XX2D_ENABLE_MINIAUDIO
+static constexpr uint32_t sampleRate = 48000, channels = 2, blockFrames = 480;	// 10ms blocks
+
+static int BenchMix(size_t const& numVoices) {
+	xx::Audio audio(xx::AudioModes::Offline, numVoices, sampleRate, channels);
+	audio.cd = 0;
+	auto&& s = audio.Load("res/1.ogg");
+	std::vector<float> buf(blockFrames * channels);
+
+	double best = std::numeric_limits<double>::max();
+	for (int round = 0; round < 5; ++round) {
+		double secs{};
+		for (uint32_t i = 0; i < sampleRate / blockFrames; ++i) {
+			if (i % 10 == 0) {
+				for (size_t j = 0; j < numVoices; ++j) audio.Play(s);	// re-trigger: keep all voices busy ( steal the oldest )
+			}
+			auto t = xx::NowEpochSeconds();
+			audio.Mix(buf.data(), blockFrames);
+			secs += xx::NowEpochSeconds(t);
+		}
+		best = std::min(best, secs);
+	}
+	auto playing = audio.GetPlayingCount();
+	xx::CoutN("voices = ", numVoices, " playing = ", playing, " mix ms per audio sec = ", best * 1000, " ( realtime x ", 1 / best, " )"
+		, " steal = ", audio.stealCount, " drop = ", audio.dropCount);
+	return playing > numVoices ? 1 : 0;
+}
+
+static void BenchLatency() {
+	xx::Audio audio(xx::AudioModes::Offline, 1, sampleRate, channels);
+	audio.cd = 0;
+	auto&& s = audio.Load("res/1.ogg");
+	auto pcm = (float const*)s->frames;
+	uint64_t lead{};	// leading silence of the sound itself
+	while (lead < s->frameCount && pcm[lead * channels] == 0 && pcm[lead * channels + 1] == 0) ++lead;
+
+	std::vector<float> buf(blockFrames * channels);
+	audio.Mix(buf.data(), blockFrames);
+	double sum{}, worst{};
+	int64_t maxOffset{};
+	int n = 1000;
+	for (int i = 0; i < n; ++i) {
+		auto t = xx::NowEpochSeconds();
+		audio.Play(s);	// same voice: stop, seek to 0, start
+		audio.Mix(buf.data(), blockFrames);
+		auto secs = xx::NowEpochSeconds(t);
+		sum += secs;
+		worst = std::max(worst, secs);
+		auto first = (int64_t)((std::find_if(buf.begin(), buf.end(), [](float f) { return f != 0; }) - buf.begin()) / channels);
+		maxOffset = std::max(maxOffset, first - (int64_t)lead);
+	}
+	xx::CoutN("trigger to first sample: avg us = ", sum / n * 1000000, " worst us = ", worst * 1000000
+		, " max frames after block start ( minus sound's leading silence ) = ", maxOffset);
+}
+
+static int BenchBG() {
+	xx::Audio audio(xx::AudioModes::Offline, 8, sampleRate, channels);
+	auto t = xx::NowEpochSeconds();
+	audio.PlayBG("res/bg.ogg");
+	audio.Flush();
+	auto startSecs = xx::NowEpochSeconds(t);
+	std::vector<float> buf(blockFrames * channels);
+	size_t sounds{}, peakBytes{};
+	double mixSecs{};
+	for (uint32_t i = 0; i < sampleRate * 60 / blockFrames; ++i) {
+		if (i % (sampleRate * 10 / blockFrames) == 0) {
+			peakBytes = std::max(peakBytes, audio.GetBGMemorySize());	// not timed
+		}
+		t = xx::NowEpochSeconds();
+		audio.Mix(buf.data(), blockFrames);
+		mixSecs += xx::NowEpochSeconds(t);
+		if (std::any_of(buf.begin(), buf.end(), [](float f) { return f != 0; })) ++sounds;
+	}
+	peakBytes = std::max(peakBytes, audio.GetBGMemorySize());
+	xx::CoutN("bg: PlayBG + Flush ms = ", startSecs * 1000, " mix ms per audio min = ", mixSecs * 1000
+		, " peak bytes per audio min = ", peakBytes, " ( res/bg.ogg file bytes = ", std::filesystem::file_size("res/bg.ogg"), " )"
+		, " non silent blocks = ", sounds, " / ", sampleRate * 60 / blockFrames);
+	return sounds ? 0 : 1;
+}
+#endif
+
+int main() {
+#ifdef XX2D_ENABLE_MINIAUDIO
+	xx::engine.Init();
+	int r = 0;
+	for (size_t n : { 8, 16, 32, 64, 128, 256 }) {
+		r |= BenchMix(n);
+	}
+	BenchLatency();
+	r |= BenchBG();
+	xx::CoutN("device mode's extra latency = device period ( ma_engine_config.periodSizeInFrames, default 10ms ) + driver buffer");
+	return r;
+#else
+	xx::CoutN("XX2D_ENABLE_MINIAUDIO is off");
+	return 0;
+#endif
+}
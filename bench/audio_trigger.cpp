@@ -0,0 +1,66 @@
+﻿#include "xx2d.h"
+
+// game thread cost of Audio::Play ( AudioModes::Offline: no device. run anywhere ). run at repo root ( res/1.ogg ~ 6.ogg )
+// 10000 triggers on 6 cached sounds, flush every 500 ( queue never full ): avg secs per Play
+// then game thread stall: 300 frames, P triggers per frame then sleep 16ms. avg & worst per Play, queue full count ( Play return false, never block )
+// exit code 1 when a Play of the first part is rejected or playing voices exceed numVoices
+
+#ifdef XX2D_ENABLE_MINIAUDIO
+static int BenchPlay() {
+	xx::Audio audio(xx::AudioModes::Offline);
+	audio.cd = 0;
+	std::vector<xx::Shared<xx::AudioSound>> ss;
+	for (int i = 1; i <= 6; ++i) {
+		ss.push_back(audio.Load(xx::ToString("res/", i, ".ogg")));	// decode once
+	}
+	double secs{};
+	size_t rejects{};
+	for (int i = 0; i < 10000; ++i) {
+		auto t = xx::NowEpochSeconds();
+		auto ok = audio.Play(ss[i % ss.size()]);	// 1 POD push. voice select / steal on audio thread
+		secs += xx::NowEpochSeconds(t);
+		if (!ok) ++rejects;
+		if (i % 500 == 499) audio.Flush();
+	}
+	auto playing = audio.GetPlayingCount();
+	xx::CoutN("avg Play secs = ", secs / 10000, " voices = ", audio.voices.size(), " playing = ", playing, " steal = ", audio.stealCount, " rejects = ", rejects);
+	return rejects || playing > audio.voices.size() ? 1 : 0;
+}
+
+static void BenchStall(int const& numPlaysPerFrame) {
+	xx::Audio audio(xx::AudioModes::Offline);
+	audio.cd = 0;
+	auto&& s = audio.Load("res/1.ogg");
+	double sum{}, worst{}, batch{};
+	size_t fulls{};
+	for (int f = 0; f < 300; ++f) {
+		auto b = xx::NowEpochSeconds();
+		for (int i = 0; i < numPlaysPerFrame; ++i) {
+			auto t = xx::NowEpochSeconds();
+			if (!audio.Play(s)) ++fulls;
+			t = xx::NowEpochSeconds(t);
+			sum += t;
+			worst = std::max(worst, t);
+		}
+		batch += xx::NowEpochSeconds(b);
+		std::this_thread::sleep_for(16ms);
+	}
+	auto n = 300.0 * numPlaysPerFrame;
+	xx::CoutN("P = ", numPlaysPerFrame, " avg ns = ", sum / n * 1e9, " worst us = ", worst * 1e6
+		, " batch ns / Play ( timer included ) = ", batch / n * 1e9, " queue full = ", fulls);
+}
+#endif
+
+int main() {
+#ifdef XX2D_ENABLE_MINIAUDIO
+	xx::engine.Init();
+	auto r = BenchPlay();
+	for (int p : { 100, 1000, 5000 }) {
+		BenchStall(p);
+	}
+	return r;
+#else
+	xx::CoutN("XX2D_ENABLE_MINIAUDIO is off");
+	return 0;
+#endif
+}
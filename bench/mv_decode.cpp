@@ -0,0 +1,83 @@
+﻿#include "xx2d.h"
+
+// Mv::ForeachFrame throughput ( res/st_k100.xxmv x 10, fps include per frame hash ) with decodeAlphaParallel on / off, decodeThreads 1 / auto
+// then segments ( split by key frames ) decoded in parallel by 4 threads
+// exit code 1 when a config or the segments decode different pixels ( per frame hash of y & a planes )
+
+static uint64_t HashPlane(uint64_t h, uint8_t const* p, uint32_t w, uint32_t rows, uint32_t stride) {
+	for (uint32_t j = 0; j < rows; ++j) {
+		for (uint32_t i = 0; i < w; ++i) {
+			h = h * 31 + p[j * stride + i];
+		}
+	}
+	return h;
+}
+
+static xx::Mv::YuvaHandler MakeHashHandler(std::vector<uint64_t>& hashs) {
+	return [&hashs](int const& frameIndex, uint32_t const& w, uint32_t const& h
+		, uint8_t const* const& yData, uint8_t const* const& uData, uint8_t const* const& vData, uint8_t const* const& aData
+		, uint32_t const& yaStride, uint32_t const& uvStride)->int {
+			auto v = HashPlane(0, yData, w, h, yaStride);
+			if (aData) v = HashPlane(v, aData, w, h, yaStride);
+			hashs[frameIndex] = v;
+			return 0;
+		};
+}
+
+int main() {
+	xx::engine.Init();
+	auto [d, f] = xx::engine.LoadFileData("res/st_k100.xxmv");
+	int r = 0;
+	std::vector<uint64_t> hashs, hashs0;
+	for (int i = 0; i < 4; ++i) {
+		xx::Mv mv;
+		if (int e = mv.Load(d)) {
+			xx::CoutN("load res/st_k100.xxmv failed. r = ", e);
+			return 1;
+		}
+		mv.decodeAlphaParallel = i & 1;
+		mv.decodeThreads = i < 2 ? 1 : 0;
+		hashs.assign(mv.count, 0);
+		auto secs = xx::NowEpochSeconds();
+		auto hh = MakeHashHandler(hashs);
+		for (int j = 0; j < 10; ++j) {
+			if (int e = mv.ForeachFrame(hh)) {
+				xx::CoutN("decode failed. r = ", e);
+				return 1;
+			}
+		}
+		secs = xx::NowEpochSeconds(secs);
+		xx::CoutN("parallel alpha = ", mv.decodeAlphaParallel, " threads = ", mv.decodeThreads, " fps = ", mv.count * 10 / secs);
+		if (i == 0) hashs0 = hashs;
+		else if (hashs != hashs0) r = 1;
+	}
+
+	{
+		xx::Mv mv;
+		mv.Load(d);
+		mv.decodeThreads = 1;
+		hashs.assign(mv.count, 0);
+		std::atomic<int> err{};
+		auto secs = xx::NowEpochSeconds();
+		for (int j = 0; j < 10; ++j) {
+			xx::ThreadPool<> tp(4);
+			for (size_t i = 0; i < mv.keyFrames.size(); ++i) {
+				auto b = mv.keyFrames[i];
+				auto e = i + 1 < mv.keyFrames.size() ? mv.keyFrames[i + 1] : mv.count;
+				tp.Add([&, b, e] {
+					if (int r = mv.ForeachFrame(MakeHashHandler(hashs), b, e)) err = r;
+				});
+			}
+		}
+		secs = xx::NowEpochSeconds(secs);
+		xx::CoutN("segments = ", mv.keyFrames.size(), " 4 threads fps = ", mv.count * 10 / secs);
+		if (err) {
+			xx::CoutN("decode failed. r = ", err.load());
+			return 1;
+		}
+		if (hashs != hashs0) r = 1;
+	}
+
+	if (r) xx::CoutN("DECODE MISMATCH");
+	return r;
+}
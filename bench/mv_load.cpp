@@ -0,0 +1,54 @@
+﻿#include "xx2d.h"
+
+// Mv::Load( Data_r ) vs Load( Data&& ) vs LoadView on a synthetic ~100 MB .xxmv ( res/st_k100.xxmv's frames repeated, every repeat start with a key frame )
+// prints secs & copied bytes per mode. exit code 1 when a zero copy mode copies the payload or the modes disagree on frame count
+
+int main() {
+	xx::engine.Init();
+	xx::Data d;
+	{
+		auto [fd, fp] = xx::engine.LoadFileData("res/st_k100.xxmv");
+		xx::Mv src;
+		if (int r = src.Load(fd)) {
+			xx::CoutN("load res/st_k100.xxmv failed. r = ", r);
+			return 1;
+		}
+		uint32_t siz = 0;
+		for (auto& len : src.lens) siz += len;
+		uint32_t n = 100 * 1024 * 1024 / siz + 1;
+		xx::Mv big;	// frame table repeated n times, bufs point into src
+		big.codecId = src.codecId;
+		big.hasAlpha = src.hasAlpha;
+		big.width = src.width;
+		big.height = src.height;
+		big.duration = src.duration * n;
+		for (uint32_t i = 0; i < n; ++i) {
+			big.lens.insert(big.lens.end(), src.lens.begin(), src.lens.end());
+			big.bufs.insert(big.bufs.end(), src.bufs.begin(), src.bufs.end());
+			for (auto k : src.keyFrames) big.keyFrames.push_back(i * src.count + k);
+		}
+		big.WriteTo(d);
+	}
+	xx::CoutN("file bytes = ", d.len);
+
+	int r = 0;
+	uint32_t count = 0;
+	for (int mode = 0; mode < 3; ++mode) {
+		xx::Data md(d);
+		auto buf = md.buf;
+		xx::Mv mv;
+		auto secs = xx::NowEpochSeconds();
+		int e = mode == 0 ? mv.Load(md) : (mode == 1 ? mv.Load(std::move(md)) : mv.LoadView(md));
+		secs = xx::NowEpochSeconds(secs);
+		if (e) {
+			xx::CoutN("mode ", mode, " load failed. r = ", e);
+			return 1;
+		}
+		bool inPlace = mv.bufs[0] >= buf && mv.bufs[0] < buf + d.len;
+		xx::CoutN(mode == 0 ? "Load( Data_r )" : (mode == 1 ? "Load( Data&& )" : "LoadView"), " secs = ", secs
+			, " copied bytes = ", mode == 1 ? mv.data.len - d.len : mv.data.len, " frames = ", mv.count, inPlace ? " zero copy" : " copied");
+		if (mode == 0) count = mv.count;
+		else if (!inPlace || mv.count != count) r = 1;
+	}
+	return r;
+}
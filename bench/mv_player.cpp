@@ -0,0 +1,60 @@
+﻿#include "xx2d.h"
+
+// MvPlayer on res/st_k100.xxmv, no gl ( Update is not called: poll GetReadyCount instead ), ring size 2 / 4 / 8:
+// first frame latency ( Init -> 1 frame ready ), seek latency ( Seek -> target frame ready: nearest key frame + catch up decode ), ring bytes when full
+// exit code 1 when decode fails, times out, or a seek delivers another frame than its target
+
+// wait until n frames are ready. return secs since t, -1: error / timeout
+static double WaitReady(xx::MvPlayer& p, size_t const& n, double const& t, int64_t* headIndex = nullptr) {
+	while (p.GetReadyCount(headIndex) < n) {
+		if (p.error || xx::NowEpochSeconds() - t > 10) return -1;
+		std::this_thread::yield();
+	}
+	return xx::NowEpochSeconds() - t;
+}
+
+int main() {
+	xx::engine.Init();
+	auto [d, f] = xx::engine.LoadFileData("res/st_k100.xxmv");
+	xx::Mv mv;
+	if (int e = mv.Load(d)) {
+		xx::CoutN("load res/st_k100.xxmv failed. r = ", e);
+		return 1;
+	}
+	xx::CoutN("frames = ", mv.count, " size = ", mv.width, " x ", mv.height, " alpha = ", mv.hasAlpha, " key frames = ", mv.keyFrames.size());
+
+	// seek targets: a key frame ( no catch up ), the frame before the last key frame ( longest catch up ), middle
+	auto lastKey = mv.keyFrames.back();
+	std::vector<uint32_t> targets{ lastKey, mv.count / 2 };
+	if (lastKey) targets.push_back(lastKey - 1);
+
+	for (size_t ringSize : { 2, 4, 8 }) {
+		xx::MvPlayer p;
+		auto t = xx::NowEpochSeconds();
+		if (int e = p.Init(mv, 60, ringSize)) {
+			xx::CoutN("init failed. r = ", e);
+			return 1;
+		}
+		auto initSecs = xx::NowEpochSeconds() - t;
+		auto firstSecs = WaitReady(p, 1, t);
+		if (firstSecs < 0 || WaitReady(p, ringSize, t) < 0) {
+			xx::CoutN("decode failed. error = ", p.error.load());
+			return 1;
+		}
+		xx::CoutN("ring = ", ringSize, " Init ms = ", initSecs * 1000, " first frame ms = ", firstSecs * 1000, " ring bytes = ", p.GetMemorySize());
+
+		for (auto target : targets) {
+			int64_t head;
+			t = xx::NowEpochSeconds();
+			p.Seek(target);
+			auto secs = WaitReady(p, 1, t, &head);
+			if (secs < 0 || head != target) {
+				xx::CoutN("seek ", target, " failed. head = ", head, " error = ", p.error.load());
+				return 1;
+			}
+			auto key = mv.FindKeyFrame(target);
+			xx::CoutN("    seek ", target, " ( key frame ", key, ", catch up ", target - key, " frames ) ms = ", secs * 1000);
+		}
+	}
+	return 0;
+}
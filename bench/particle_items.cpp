@@ -0,0 +1,100 @@
+﻿#include "xx2d.h"
+
+#include "xx_listlink.h"
+
+// ParticleItems ( SoA blocks, simd ) vs the old xx::ListLink<ParticleItem, int> walk ( Particle::Update before SoA ): 1M random particles
+// ( terminalAge 0.05 ~ 3.5 ), 60 frames at 1/60. UpdateAge & Integrate timed apart. build with -DXX2D_ENABLE_AVX2=ON to measure the AVX2 path
+// exit code 1 when the alive items after 60 frames differ ( bitwise, as a multiset: the two storages keep different orders )
+
+// the old Particle::Update loop, verbatim ( Remove in the middle of the walk )
+static void UpdateListLink(xx::ListLink<xx::ParticleItem, int>& particles, xx::XY const& pos, float const& delta) {
+	float ang;
+	int prev = -1, next{};
+	for (auto idx = particles.head; idx != -1;) {
+		auto& p = particles[idx];
+
+		p.age += delta;
+		if (p.age >= p.terminalAge) {
+			next = particles.Remove(idx, prev);
+		} else {
+			next = particles.Next(idx);
+			prev = idx;
+			{
+				xx::XY vecAccel = p.pos - pos;
+				vecAccel.Normalize();
+				xx::XY vecAccel2 = vecAccel;
+				vecAccel *= p.radialAccel;
+
+				ang = vecAccel2.x;
+				vecAccel2.x = -vecAccel2.y;
+				vecAccel2.y = ang;
+
+				vecAccel2 *= p.tangentialAccel;
+				p.velocity += (vecAccel + vecAccel2) * delta;
+				p.velocity.y += p.gravity * delta;
+
+				p.pos += p.velocity * delta;
+
+				p.spin += p.spinDelta * delta;
+				p.size += p.sizeDelta * delta;
+				p.color += p.colorDelta * delta;
+			}
+		}
+		idx = next;
+	}
+}
+
+static void SortBytes(std::vector<xx::ParticleItem>& ps) {
+	std::sort(ps.begin(), ps.end(), [](auto const& a, auto const& b) { return memcmp(&a, &b, sizeof(a)) < 0; });
+}
+
+int main() {
+	static constexpr size_t n = 1000000;
+	static constexpr float delta = 1 / 60.f;
+	xx::XY center{ 10, 20 };
+	xx::SmallRnd rnd(1);
+	std::vector<xx::ParticleItem> src(n);
+	for (auto& p : src) {
+		p.pos = { rnd.Next(-1000.f, 1000.f), rnd.Next(-1000.f, 1000.f) };
+		p.velocity = { rnd.Next(-300.f, 300.f), rnd.Next(-300.f, 300.f) };
+		p.gravity = rnd.Next(-200.f, 200.f);
+		p.radialAccel = rnd.Next(-130.f, 200.f);
+		p.tangentialAccel = rnd.Next(-200.f, 270.f);
+		p.spin = rnd.Next(-5.f, 5.f);
+		p.spinDelta = rnd.Next(-1.f, 1.f);
+		p.size = rnd.Next(0.5f, 5.f);
+		p.sizeDelta = rnd.Next(-1.f, 1.f);
+		p.age = 0;
+		p.terminalAge = rnd.Next(0.05f, 3.5f);
+		p.color = { rnd.Next(0.f, 1.f), rnd.Next(0.f, 1.f), rnd.Next(0.f, 1.f), rnd.Next(0.f, 1.f) };
+		p.colorDelta = { rnd.Next(-1.f, 1.f), rnd.Next(-1.f, 1.f), rnd.Next(-1.f, 1.f), rnd.Next(-1.f, 1.f) };
+	}
+	xx::ListLink<xx::ParticleItem, int> ll;
+	ll.Reserve((int)n);
+	for (auto& p : src) ll.Add() = p;
+	xx::ParticleItems soa;
+	soa.Init({}, n);
+	for (auto& p : src) soa.Add(p);
+
+	double llSecs{}, ageSecs{}, integrateSecs{};
+	for (int f = 0; f < 60; ++f) {
+		auto t = xx::NowEpochSeconds();
+		UpdateListLink(ll, center, delta);
+		llSecs += xx::NowEpochSeconds(t);
+		soa.UpdateAge(delta);
+		ageSecs += xx::NowEpochSeconds(t);
+		soa.Integrate(center, delta, 0, soa.len);
+		integrateSecs += xx::NowEpochSeconds(t);
+	}
+	xx::CoutN("ListLink walk ms / frame = ", llSecs / 60 * 1000);
+	xx::CoutN("ParticleItems ms / frame = ", (ageSecs + integrateSecs) / 60 * 1000, " ( UpdateAge ", ageSecs / 60 * 1000, ", Integrate ", integrateSecs / 60 * 1000, " )");
+
+	std::vector<xx::ParticleItem> a, b;
+	for (auto idx = ll.head; idx != -1; idx = ll.Next(idx)) a.push_back(ll[idx]);
+	for (size_t i = 0; i < soa.len; ++i) b.push_back(soa[i]);
+	SortBytes(a);
+	SortBytes(b);
+	int r = a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(xx::ParticleItem)) == 0 ? 0 : 1;
+	xx::CoutN("alive = ", soa.len, r ? " MISMATCH" : " identical");
+	return r;
+}
@@ -0,0 +1,123 @@
+﻿#include "xx2d.h"
+
+// 1. ParticleSystem::Update: 500 emitters ( emission 1000, life 0.5 ~ 1.5s, ~500k alive ), 120 frames at 1/60, numThreads 1 / 2 / 4 / 8
+//    hash of all particle fields after the last frame must be the same for every numThreads
+// 2. shared pool, big battle: 500 emitters ( cap 2000, 0.5s bursts, 10 re-fire per frame ), budget 200000, 600 frames at 1/60
+//    deny policy Drop / Defer x numThreads 1 / 4: pool memory, max alive, avg budget use, avg block fill, denied spawns, ms / frame
+//    alive must stay <= budget, alive / denied / hash must be the same for every numThreads
+// exit code 1 when a check fails
+
+// lifetime < 0: fire forever
+static xx::Shared<xx::ParticleConfig> MakeConfig(float const& lifetime) {
+	auto cfg = xx::Make<xx::ParticleConfig>();
+	cfg->emission = 1000;
+	cfg->lifetime = lifetime;
+	cfg->particleLife = { 0.5f, 1.5f };
+	cfg->direction = 0;
+	cfg->spread = float(M_PI * 2);
+	cfg->relative = 0;
+	cfg->speed = { -100.f, 300.f };
+	cfg->gravity = { -200.f, 180.f };
+	cfg->radialAccel = { -130.f, 200.f };
+	cfg->tangentialAccel = { -200.f, 270.f };
+	cfg->size = { 0.5f, 5.f };
+	cfg->sizeVar = 0.4f;
+	cfg->spin = {};
+	cfg->spinVar = 0;
+	cfg->color = { { 1, 0, 0, 0.7f }, { 0, 1, 1, 0.3f } };
+	cfg->colorVar = 0.5f;
+	cfg->alphaVar = 1;
+	return cfg;
+}
+
+static uint64_t Hash(xx::ParticleSystem const& ps) {
+	uint64_t h = 1469598103934665603ull;	// fnv-1a
+	for (auto&& e : ps.emitters) {
+		auto& items = e->particles;
+		for (size_t i = 0; i < items.len; ++i) {
+			auto o = items[i];
+			auto p = (uint8_t const*)&o;
+			for (size_t j = 0; j < sizeof(o); ++j) {
+				h ^= p[j];
+				h *= 1099511628211ull;
+			}
+		}
+	}
+	return h;
+}
+
+static int BenchThreads() {
+	auto cfg = MakeConfig(-1.f);
+	std::optional<uint64_t> h0;
+	int r = 0;
+	for (size_t nt : { 1, 2, 4, 8 }) {
+		xx::ParticleSystem ps;
+		ps.Init(12345, nt, 1000000);
+		for (int i = 0; i < 500; ++i) {
+			ps.Add(cfg, 2000).FireAt({ float(i % 25) * 40 - 500, float(i / 25) * 40 - 400 });
+		}
+		double secs{};
+		for (int f = 0; f < 120; ++f) {
+			auto t = xx::NowEpochSeconds();
+			ps.Update(1 / 60.f);
+			secs += xx::NowEpochSeconds(t);
+		}
+		auto h = Hash(ps);
+		if (!h0) h0 = h;
+		else if (*h0 != h) r = 1;
+		xx::CoutN("numThreads = ", nt, " particles = ", ps.GetParticleCount(), " ms / frame = ", secs / 120 * 1000, " hash = ", h, *h0 == h ? "" : " MISMATCH");
+	}
+	xx::CoutN("hardware_concurrency = ", std::thread::hardware_concurrency(), ". numThreads over it only add switches");
+	return r;
+}
+
+
+static int BenchPool() {
+	static constexpr size_t numEmitters = 500, budget = 200000;
+	static constexpr int numFrames = 600;
+	auto cfg = MakeConfig(0.5f);
+	int r = 0;
+	for (auto policy : { xx::ParticleDenyPolicies::Drop, xx::ParticleDenyPolicies::Defer }) {
+		std::optional<std::tuple<size_t, uint64_t, uint64_t>> result0;
+		for (size_t nt : { 1, 4 }) {
+			xx::ParticleSystem ps;
+			ps.Init(12345, nt, budget);
+			for (size_t i = 0; i < numEmitters; ++i) {
+				auto&& p = ps.Add(cfg, 2000);
+				p.denyPolicy = policy;
+				p.FireAt({ float(i % 25) * 40 - 500, float(i / 25) * 40 - 400 });
+			}
+			size_t maxAlive{};
+			double sumUsage{}, sumFill{}, secs{};
+			for (int f = 0; f < numFrames; ++f) {
+				for (size_t i = 0; i < 10; ++i) {
+					ps.emitters[(f * 10 + i) % numEmitters]->Fire();
+				}
+				auto t = xx::NowEpochSeconds();
+				ps.Update(1 / 60.f);
+				secs += xx::NowEpochSeconds(t);
+				auto s = ps.GetStats();
+				maxAlive = std::max(maxAlive, s.alive);
+				sumUsage += s.budgetUsage;
+				sumFill += s.blockFill;
+			}
+			auto s = ps.GetStats();
+			std::tuple<size_t, uint64_t, uint64_t> result{ s.alive, s.denied, Hash(ps) };
+			if (maxAlive > budget) r = 1;
+			if (!result0) result0 = result;
+			else if (*result0 != result) r = 1;
+			xx::CoutN(policy == xx::ParticleDenyPolicies::Drop ? "Drop" : "Defer", " numThreads = ", nt
+				, " pool MB = ", double(s.numBlocks * xx::ParticlePool::blockSize * xx::ParticlePool::numFields * sizeof(float)) / 1024 / 1024
+				, " ( ", s.numBlocks, " blocks, peak used ", s.peakUsedBlocks, " )"
+				, " max alive = ", maxAlive, " avg budget use = ", sumUsage / numFrames, " avg block fill = ", sumFill / numFrames
+				, " denied = ", s.denied, " ms / frame = ", secs / numFrames * 1000, " hash = ", std::get<2>(result), *result0 == result ? "" : " MISMATCH");
+		}
+	}
+	return r;
+}
+
+int main() {
+	int r = BenchThreads();
+	r |= BenchPool();
+	return r;
+}
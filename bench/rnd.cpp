@@ -0,0 +1,117 @@
+﻿#include "xx2d.h"
+
+// Rnd ( mt19937 ) vs SmallRnd ( xoshiro128** ): 2^26 numbers written into a 4096 items buffer ( L1 / L2 ), best of 2 runs
+// build with -DXX2D_ENABLE_AVX2=ON to measure the AVX2 build ( bulk fills are plain loops: compiler vectorize them )
+// then quality with seed 123: top 8 bits chi2, 32 bits balance, NextInts chi2 & range, same seed / Fork / memcpy round trip
+// exit code 1 when a quality check fails ( chi2 over 99% critical value: 310 for 255 dof, 135 for 99 dof, or |z| > 4 )
+
+static constexpr size_t total = 1 << 26, bufLen = 4096;
+
+template<typename T, typename F>
+static void Bench(char const* name, F&& f) {
+	std::vector<T> buf(bufLen);
+	double best = std::numeric_limits<double>::max();
+	uint64_t sum{};
+	for (int run = 0; run < 2; ++run) {
+		auto t = xx::NowEpochSeconds();
+		for (size_t i = 0; i < total; i += bufLen) {
+			f(std::span<T>(buf));
+			sum += std::bit_cast<uint32_t>(buf[i / bufLen % bufLen]);	// sink: keep f's work
+		}
+		best = std::min(best, xx::NowEpochSeconds(t));
+	}
+	xx::CoutN(name, " ms = ", best * 1000, " ( ", sum, " )");
+}
+
+static double Chi2(std::vector<uint64_t> const& counts, size_t n) {
+	double e = double(n) / counts.size(), r{};
+	for (auto c : counts) r += (c - e) * (c - e) / e;
+	return r;
+}
+
+// top 8 bits chi2 & max |z| of each bit's balance
+static int CheckBits(char const* name, std::vector<uint32_t> const& vs, int numBits) {
+	std::vector<uint64_t> top(256), ones(numBits);
+	for (auto v : vs) {
+		++top[v >> 24];
+		for (int b = 0; b < numBits; ++b) ones[b] += (v >> (32 - numBits + b)) & 1;
+	}
+	double maxZ{};
+	for (auto o : ones) maxZ = std::max(maxZ, std::abs((o - vs.size() / 2.0) / std::sqrt(vs.size() / 4.0)));
+	auto c = Chi2(top, vs.size());
+	xx::CoutN(name, " top 8 bits chi2 = ", c, " max |z| of ", numBits, " bits balance = ", maxZ);
+	return c > 310 || maxZ > 4 ? 1 : 0;
+}
+
+int main() {
+	Bench<uint32_t>("Rnd Get", [r = xx::Rnd()](std::span<uint32_t> o) mutable { for (auto& v : o) v = r.Get(); });
+	Bench<uint32_t>("SmallRnd Get", [r = xx::SmallRnd()](std::span<uint32_t> o) mutable { for (auto& v : o) v = r.Get(); });
+	Bench<uint32_t>("SmallRnd NextU32s", [r = xx::SmallRnd()](std::span<uint32_t> o) mutable { r.NextU32s(o); });
+	Bench<float>("Rnd Next<float>", [r = xx::Rnd()](std::span<float> o) mutable { for (auto& v : o) v = r.Next<float>(); });
+	Bench<float>("SmallRnd NextFloat", [r = xx::SmallRnd()](std::span<float> o) mutable { for (auto& v : o) v = r.NextFloat(); });
+	Bench<float>("SmallRnd NextFloats", [r = xx::SmallRnd()](std::span<float> o) mutable { r.NextFloats(o); });
+	Bench<float>("SmallRnd NextFloats(-1, 1)", [r = xx::SmallRnd()](std::span<float> o) mutable { r.NextFloats(o, -1, 1); });
+	Bench<int32_t>("Rnd Next(0, 99) ( % : biased )", [r = xx::Rnd()](std::span<int32_t> o) mutable { for (auto& v : o) v = r.Next(0, 99); });
+	Bench<int32_t>("SmallRnd NextInt(0, 99)", [r = xx::SmallRnd()](std::span<int32_t> o) mutable { for (auto& v : o) v = r.NextInt(0, 99); });
+	Bench<int32_t>("SmallRnd NextInts(0, 99)", [r = xx::SmallRnd()](std::span<int32_t> o) mutable { r.NextInts(o, 0, 99); });
+
+	int r = 0;
+	std::vector<uint32_t> us(total);
+	{
+		xx::SmallRnd g(123);
+		for (auto& v : us) v = g.Get();
+		r |= CheckBits("Get", us, 32);
+	}
+	{
+		xx::SmallRnd g(123);
+		g.NextU32s(us);
+		r |= CheckBits("NextU32s", us, 32);
+	}
+	{
+		std::vector<float> fs(total);
+		xx::SmallRnd g(123);
+		g.NextFloats(fs);
+		auto [mn, mx] = std::minmax_element(fs.begin(), fs.end());
+		double sum{};
+		for (size_t i = 0; i < fs.size(); ++i) {
+			sum += fs[i];
+			us[i] = (uint32_t)(fs[i] * 8388608.f) << 9;	// 23 mantissa bits to the top
+		}
+		xx::CoutN("NextFloats min = ", *mn, " max = ", *mx, " mean = ", sum / fs.size());
+		r |= CheckBits("NextFloats", us, 23);
+		if (*mn < 0 || *mx >= 1) r = 1;
+	}
+	{
+		std::vector<int32_t> is(total);
+		xx::SmallRnd g(123);
+		g.NextInts(is, 0, 99);
+		std::vector<uint64_t> counts(100);
+		bool inRange = true;
+		for (auto v : is) {
+			if (v < 0 || v > 99) inRange = false;
+			else ++counts[v];
+		}
+		auto c = Chi2(counts, is.size());
+		g.NextInts(is, -1, std::numeric_limits<int32_t>::max());	// ~50% reject
+		for (auto v : is) {
+			if (v < -1) inRange = false;
+		}
+		xx::CoutN("NextInts(0, 99) chi2 = ", c, " in range = ", inRange);
+		if (c > 135 || !inRange) r = 1;
+	}
+	{
+		xx::SmallRnd a(123), b(123);
+		std::vector<float> fa(10000), fb(10000);
+		a.NextFloats(fa);
+		b.NextFloats(fb);
+		bool same = fa == fb && !memcmp(a.s, b.s, sizeof(a.s));
+		auto f = a.Fork();
+		bool forkDiffer = f.Get() != a.Get();
+		xx::SmallRnd c;
+		memcpy(&c, &b, sizeof(c));
+		bool roundTrip = c.Get() == b.Get();
+		xx::CoutN("same seed same numbers & state = ", same, " Fork differ = ", forkDiffer, " memcpy round trip = ", roundTrip);
+		if (!same || !forkDiffer || !roundTrip) r = 1;
+	}
+	return r;
+}
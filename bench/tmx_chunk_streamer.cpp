@@ -0,0 +1,55 @@
+﻿#include "xx2d.h"
+
+// soak: fly camera ( 1920 x 1080 ) across a synthetic 100k x 100k tiles infinite map ( 256 x 256 tiles per zstd chunk ), 1 tile per frame diagonal
+// prints total secs & max loaded chunks. exit code 1 when a streamed gid differs from the source
+
+using namespace xx::TMX;
+
+int main() {
+	Map map;
+	map.infinite = true;
+	map.tileWidth = map.tileHeight = 32;
+	map.width = map.height = 100000;
+	auto&& L = xx::Make<Layer_Tile>();
+	L->type = LayerTypes::TileLayer;
+	{
+		std::vector<uint32_t> gids(256 * 256);
+		for (size_t i = 0; i < gids.size(); ++i) gids[i] = uint32_t(i % 7 + 1);
+		xx::Data zgids;
+		xx::ZstdCompress({ (char*)gids.data(), gids.size() * 4 }, zgids, 1);
+		for (int32_t y = 0; y < 100000; y += 256) {
+			for (int32_t x = 0; x < 100000; x += 256) {
+				auto&& c = L->chunks.emplace_back();
+				c.width = c.height = 256;
+				c.pos = { x, y };
+				c.zgids.WriteBuf(zgids.buf, zgids.len);
+			}
+		}
+	}
+	auto&& lt = *L;
+	map.layers.emplace_back(std::move(L));
+
+	Camera cam;
+	cam.Init({ 1920, 1080 }, map);
+	ChunkStreamer cs;
+	cs.Init(map, 4);
+	int r = 0;
+	size_t maxLoadeds = 0;
+	auto secs = xx::NowEpochSeconds();
+	for (int i = 0; i <= 100000; ++i) {
+		cam.SetPosition({ i * 32.f, i * 32.f });
+		cam.Commit();
+		cs.Update(cam);
+		if (i % 1000 == 0) {
+			cs.Flush();
+			if (cs.GetGid(lt, i, i) != uint32_t((i % 256) * 256 + i % 256) % 7 + 1) {
+				xx::CoutN("gid mismatch at ", i, ", ", i);
+				r = 1;
+			}
+		}
+		maxLoadeds = std::max(maxLoadeds, cs.numLoadeds);
+	}
+	cs.Flush();
+	xx::CoutN("secs = ", xx::NowEpochSeconds(secs), ", chunks = ", lt.chunks.size(), ", max loadeds = ", maxLoadeds, ", loadeds = ", cs.numLoadeds);
+	return r;
+}
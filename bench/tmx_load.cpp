@@ -0,0 +1,106 @@
+﻿#include "xx2d.h"
+
+// .tmx ( xml parse ) vs precompiled .tmb load. synthetic map in temp dir ( loadTextures = false: no gl context ):
+// 512 x 512, 4 csv tile layers, 2000 rectangle objects with properties. exit code 1 when tmb's content differs from tmx's
+// then gids restore only: 1024 x 1024 one layer map, FillFromBin from memory
+
+using namespace xx::TMX;
+
+static uint64_t Checksum(Map const& map) {
+	uint64_t h = map.layers.size();
+	for (auto&& L : map.layers) {
+		if (L->type == LayerTypes::TileLayer) {
+			auto& T = (Layer_Tile&)*L;
+			for (uint32_t y = 0; y < T.height; ++y) {
+				for (uint32_t x = 0; x < T.width; ++x) {
+					h = h * 31 + T.GetGid(x, y);
+				}
+			}
+		} else if (L->type == LayerTypes::ObjectLayer) {
+			for (auto&& o : ((Layer_Object&)*L).objects) {
+				h = h * 31 + o->id + (uint64_t)o->x * 7 + (uint64_t)o->y * 13 + o->properties.size();
+			}
+		}
+	}
+	return h;
+}
+
+int main() {
+	xx::engine.Init();
+	auto dir = std::filesystem::temp_directory_path() / "xx2d_bench_tmx";
+	std::filesystem::create_directories(dir);
+	auto tmxfn = (dir / "m.tmx").generic_string(), tmbfn = (dir / "m.tmb").generic_string();
+	xx::SmallRnd rnd(1);
+	{
+		std::string tsx = R"(<?xml version="1.0" encoding="UTF-8"?><tileset version="1.9" name="t" tilewidth="32" tileheight="32" tilecount="256" columns="16"><image source="t.png" width="512" height="512"/>)";
+		for (int i = 0; i < 256; ++i) {
+			tsx += xx::ToString(R"(<tile id=")", i, R"("><properties><property name="hp" type="int" value=")", i, R"("/></properties></tile>)");
+		}
+		tsx += "</tileset>";
+		xx::WriteAllBytes(dir / "t.tsx", tsx.data(), tsx.size());
+
+		std::string tmx = R"(<?xml version="1.0" encoding="UTF-8"?><map version="1.9" orientation="orthogonal" renderorder="right-down" width="512" height="512" tilewidth="32" tileheight="32" infinite="0" nextlayerid="6" nextobjectid="2001">)"
+			R"(<tileset firstgid="1" source="t.tsx"/>)";
+		for (int l = 1; l <= 4; ++l) {
+			tmx += xx::ToString(R"(<layer id=")", l, R"(" name="L)", l, R"(" width="512" height="512"><data encoding="csv">)");
+			for (int i = 0; i < 512 * 512; ++i) {
+				if (i) tmx += ',';
+				tmx += std::to_string(rnd.NextBounded(257));
+			}
+			tmx += "</data></layer>";
+		}
+		tmx += R"(<objectgroup id="5" name="O">)";
+		for (int i = 1; i <= 2000; ++i) {
+			tmx += xx::ToString(R"(<object id=")", i, R"(" x=")", rnd.NextBounded(16384), R"(" y=")", rnd.NextBounded(16384)
+				, R"(" width="64" height="32"><properties><property name="kind" value="k)", i % 8, R"("/></properties></object>)");
+		}
+		tmx += "</objectgroup></map>";
+		xx::WriteAllBytes(tmxfn, tmx.data(), tmx.size());
+		xx::CoutN("tmx bytes = ", tmx.size());
+	}
+
+	FillOptions opts;
+	opts.loadTextures = false;
+	Map map;
+	FillTo(map, tmxfn, opts);
+	xx::Data d;
+	WriteTo(d, map);
+	xx::WriteAllBytes(tmbfn, d);
+	xx::CoutN("tmb bytes = ", d.len);
+
+	int r = 0;
+	auto secs = xx::NowEpochSeconds();
+	for (int i = 0; i < 10; ++i) {
+		Map m;
+		FillTo(m, tmxfn, opts);
+	}
+	xx::CoutN("10 x tmx load secs = ", xx::NowEpochSeconds(secs));
+	for (int i = 0; i < 10; ++i) {
+		Map m;
+		FillTo(m, tmbfn, opts);
+		if (i == 0 && Checksum(m) != Checksum(map)) r = 1;
+	}
+	xx::CoutN("10 x tmb load secs = ", xx::NowEpochSeconds(secs), r ? " CONTENT MISMATCH" : "");
+
+	{
+		Map m;
+		m.width = m.height = 1024;
+		auto&& L = xx::Make<Layer_Tile>();
+		L->type = LayerTypes::TileLayer;
+		L->width = L->height = 1024;
+		L->denseGids.resize(1024 * 1024);
+		for (size_t i = 0; i < L->denseGids.size(); ++i) L->denseGids[i] = (uint32_t)(i % 97 + 1);
+		m.layers.emplace_back(std::move(L));
+		xx::Data bd;
+		WriteTo(bd, m);
+		secs = xx::NowEpochSeconds();
+		for (int i = 0; i < 100; ++i) {
+			Map m2;
+			FillFromBin(m2, bd, ""sv, opts);
+		}
+		xx::CoutN("100 x 1024x1024 tmb FillFromBin secs = ", xx::NowEpochSeconds(secs), ", bytes = ", bd.len);
+	}
+
+	std::filesystem::remove_all(dir);
+	return r;
+}
@@ -0,0 +1,50 @@
+﻿#include "xx2d.h"
+
+// Layer_Object index vs linear scan: 100k rectangles in 100k x 100k pixels, 1920 x 1080 view queries
+// exit code 1 when the index finds a different objects count than the linear scan for the same views
+
+using namespace xx::TMX;
+
+int main() {
+	Layer_Object L;
+	xx::Rnd rnd;
+	for (int i = 0; i < 100000; ++i) {
+		auto o = xx::Make<Object_Rectangle>();
+		o->type = ObjectTypes::Rectangle;
+		o->x = rnd.Next(0, 100000);
+		o->y = rnd.Next(0, 100000);
+		o->width = rnd.Next(16, 256);
+		o->height = rnd.Next(16, 256);
+		L.objects.emplace_back(std::move(o));
+	}
+	std::vector<std::pair<float, float>> xys(100000);
+	for (auto& xy : xys) xy = { (float)rnd.Next(0, 100000), (float)rnd.Next(0, 100000) };
+
+	auto secs = xx::NowEpochSeconds();
+	L.index.Build(L.objects);
+	xx::CoutN("build secs = ", xx::NowEpochSeconds(secs));
+
+	size_t n = 0, n1k = 0;
+	for (size_t i = 0; i < xys.size(); ++i) {
+		auto [x, y] = xys[i];
+		L.index.Query(x, y, x + 1920, y + 1080, [&](Object* o) { ++n; });
+		if (i == 999) n1k = n;
+	}
+	xx::CoutN("100k rect queries secs = ", xx::NowEpochSeconds(secs), " n = ", n);
+
+	n = 0;
+	for (size_t i = 0; i < 1000; ++i) {
+		auto [x, y] = xys[i];
+		for (auto& o : L.objects) {
+			auto b = ObjectIndex::CalcBox(*o);
+			if (!(x + 1920 < b[0] || y + 1080 < b[1] || x > b[2] || y > b[3])) ++n;
+		}
+	}
+	xx::CoutN("1k linear scans secs = ", xx::NowEpochSeconds(secs), " n = ", n);
+
+	if (n != n1k) {
+		xx::CoutN("INDEX MISMATCH: first 1k queries n = ", n1k);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,47 @@
+﻿#include "xx2d.h"
+
+// Layer_Tile dense vs sparse gids: 4096 x 4096, 2% random 16 x 16 blocks filled. memory, 10M random GetGid, full rows iterate
+// exit code 1 when the sparse layer's sums differ from the dense gids
+
+using namespace xx::TMX;
+
+int main() {
+	Layer_Tile L;
+	L.width = L.height = 4096;
+	L.denseGids.resize(L.width * L.height);
+	xx::Rnd rnd;
+	for (uint32_t by = 0; by < 256; ++by) {
+		for (uint32_t bx = 0; bx < 256; ++bx) {
+			if (rnd.Next(0, 99) >= 2) continue;
+			for (uint32_t y = 0; y < 16; ++y) for (uint32_t x = 0; x < 16; ++x) L.denseGids[(by * 16 + y) * 4096 + bx * 16 + x] = rnd.Next(1, 100);
+		}
+	}
+	auto dense = L.denseGids;
+	L.TryMakeSparse(0.5f);
+	if (!L.isSparse) {
+		xx::CoutN("TryMakeSparse failed");
+		return 1;
+	}
+	xx::CoutN("dense bytes = ", dense.size() * 4, ", sparse bytes = ", L.sparse.GetMemorySize());
+
+	int r = 0;
+	std::vector<std::pair<uint32_t, uint32_t>> xys(10000000);
+	for (auto& xy : xys) xy = { (uint32_t)rnd.Next(0, 4095), (uint32_t)rnd.Next(0, 4095) };
+	uint64_t sum = 0, sum2 = 0;
+	auto secs = xx::NowEpochSeconds();
+	for (auto& [x, y] : xys) sum += dense[y * 4096 + x];
+	xx::CoutN("dense random access secs = ", xx::NowEpochSeconds(secs), " sum = ", sum);
+	for (auto& [x, y] : xys) sum2 += L.GetGid(x, y);
+	xx::CoutN("sparse random access secs = ", xx::NowEpochSeconds(secs), " sum = ", sum2);
+	if (sum != sum2) r = 1;
+
+	sum = sum2 = 0;
+	for (uint32_t y = 0; y < 4096; ++y) for (uint32_t x = 0; x < 4096; ++x) if (auto g = dense[y * 4096 + x]) sum += g;
+	xx::CoutN("dense rows iterate secs = ", xx::NowEpochSeconds(secs), " sum = ", sum);
+	for (uint32_t y = 0; y < 4096; ++y) L.ForeachInRow(y, 0, 4096, [&](uint32_t x, uint32_t gid) { sum2 += gid; });
+	xx::CoutN("sparse rows iterate secs = ", xx::NowEpochSeconds(secs), " sum = ", sum2);
+	if (sum != sum2) r = 1;
+
+	if (r) xx::CoutN("SPARSE MISMATCH");
+	return r;
+}
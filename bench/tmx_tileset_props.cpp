@@ -0,0 +1,66 @@
+﻿#include "xx2d.h"
+
+// image-less tileset with 10k tiles ( each has 16 ~ 32 properties ): .tmx load time, then FindProperty by name for every tile,
+// with the hashed name index and with the stale index linear fallback ( index cleared )
+// exit code 1 when a lookup misses or returns another property's value
+
+using namespace xx::TMX;
+
+int main() {
+	xx::engine.Init();
+	auto dir = std::filesystem::temp_directory_path() / "xx2d_bench_tmx_props";
+	std::filesystem::create_directories(dir);
+	auto tmxfn = (dir / "m.tmx").generic_string();
+	{
+		std::string tsx = R"(<?xml version="1.0" encoding="UTF-8"?><tileset version="1.9" name="t" tilewidth="32" tileheight="32" tilecount="10000" columns="0">)";
+		for (int i = 0; i < 10000; ++i) {
+			tsx += xx::ToString(R"(<tile id=")", i, R"("><properties>)");
+			for (int j = 0, k = 16 + i % 17; j < k; ++j) {
+				tsx += xx::ToString(R"(<property name="p)", j, R"(" type="int" value=")", i * 64 + j, R"("/>)");
+			}
+			tsx += "</properties></tile>";
+		}
+		tsx += "</tileset>";
+		xx::WriteAllBytes(dir / "t.tsx", tsx.data(), tsx.size());
+		std::string tmx = R"(<?xml version="1.0" encoding="UTF-8"?><map version="1.9" orientation="orthogonal" renderorder="right-down" width="1" height="1" tilewidth="32" tileheight="32" infinite="0">)"
+			R"(<tileset firstgid="1" source="t.tsx"/><layer id="1" name="L" width="1" height="1"><data encoding="csv">1</data></layer></map>)";
+		xx::WriteAllBytes(tmxfn, tmx.data(), tmx.size());
+	}
+
+	Map map;
+	auto secs = xx::NowEpochSeconds();
+	for (int i = 0; i < 10; ++i) {
+		map = {};
+		FillTo(map, tmxfn);
+	}
+	xx::CoutN("10 x 10k tiles tmx load secs = ", xx::NowEpochSeconds(secs));
+
+	std::array<std::string, 32> names;
+	for (int i = 0; i < 32; ++i) names[i] = xx::ToString("p", i);
+	auto& tileset = *map.tilesets[0];
+	int r = 0;
+	auto&& Bench = [&](char const* title) {
+		int64_t sum = 0;
+		secs = xx::NowEpochSeconds();
+		for (int n = 0; n < 100; ++n) {
+			for (uint32_t i = 0; i < 10000; ++i) {
+				auto j = (i * 7 + n) % (16 + i % 17);
+				auto p = FindProperty(tileset.GetTile(i)->properties, names[j]);
+				if (!p || std::get<int64_t>(p->value) != i * 64 + j) {
+					r = 1;
+					break;
+				}
+				sum += std::get<int64_t>(p->value);
+			}
+		}
+		xx::CoutN("100 x 10k FindProperty ( ", title, " ) secs = ", xx::NowEpochSeconds(secs), " sum = ", sum, r ? " LOOKUP MISMATCH" : "");
+	};
+	Bench("index");
+	for (uint32_t i = 0; i < 10000; ++i) {
+		tileset.GetTile(i)->properties.index.clear();
+	}
+	Bench("linear");
+
+	std::filesystem::remove_all(dir);
+	return r;
+}
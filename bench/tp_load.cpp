@@ -0,0 +1,41 @@
+﻿#include "xx2d.h"
+
+// texture packer data: parse .plist text vs load precompiled .tpb ( compiled in memory ), 1000 times each, for every res/*.plist
+// no texture is loaded ( Fill( text ) + SortByName vs FillFromTpb, the same work Fill( plistFn ) does per format ). run at repo root
+
+int main() {
+	xx::engine.Init();
+	for (auto&& e : std::filesystem::directory_iterator("res")) {
+		if (!e.is_regular_file() || e.path().extension() != ".plist") continue;
+		auto fn = e.path().generic_string();
+		auto pd = xx::engine.LoadFileDataWithFullPath(fn);	// unpack zstd ones
+		xx::TP tp;
+		if (int r = tp.Fill(pd, ""sv)) {
+			xx::CoutN(std::string_view(fn), " skipped ( not a cocos 3.x plist ). r = ", r);
+			continue;
+		}
+		xx::Data bd;
+		tp.WriteTo(bd);
+
+		auto secs = xx::NowEpochSeconds();
+		for (int i = 0; i < 1000; ++i) {
+			tp.Fill(pd, ""sv);
+			xx::TP::SortByName(tp.frames);
+		}
+		auto plistSecs = xx::NowEpochSeconds(secs);
+		std::vector<std::string> keys;
+		for (auto& f : tp.frames) keys.push_back(f->key);
+		secs = xx::NowEpochSeconds();
+		for (int i = 0; i < 1000; ++i) tp.FillFromTpb(bd, ""sv);
+		auto tpbSecs = xx::NowEpochSeconds(secs);
+		for (size_t i = 0; i < keys.size(); ++i) {	// WriteTo must keep Fill( plistFn )'s order ( a9 before a10 ): GetToByPrefix / anim frames rely on it
+			if (i >= tp.frames.size() || tp.frames[i]->key != keys[i]) {
+				xx::CoutN(std::string_view(fn), " tpb frame order differs from sorted plist at ", i);
+				return 1;
+			}
+		}
+		xx::CoutN(std::string_view(fn), " frames = ", tp.frames.size(), " plist bytes = ", pd.len, " tpb bytes = ", bd.len
+			, " plist secs = ", plistSecs, " tpb secs = ", tpbSecs);
+	}
+	return 0;
+}
@@ -0,0 +1,73 @@
+﻿#include "xx2d.h"
+
+// YuvaToRgba: verify simd == scalar ( exit code 1 when not ) & max diff to float formula, on random planes
+// ( w 1 ~ 300, h 1 ~ 40, with / without alpha & premultiply ), then throughput of 1920 x 1080 x 50 frames
+// build with -DXX2D_ENABLE_AVX2=ON to measure the AVX2 path
+
+// float formula of Shader_Yuva2Rgba. premultiply: round( c ) * a / 255
+static void YuvaToRgba_Float(uint8_t* d, uint32_t w, uint32_t h, uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t const* a
+	, uint32_t ys, uint32_t us, bool pm) {
+	for (uint32_t j = 0; j < h; ++j) {
+		for (uint32_t i = 0; i < w; ++i) {
+			float Y = y[j * ys + i], U = u[j / 2 * us + i / 2] - 128.f, V = v[j / 2 * us + i / 2] - 128.f;
+			float c[3] = { Y + 1.402f * V, Y - 0.344f * U - 0.714f * V, Y + 1.772f * U };
+			float A = a ? a[j * ys + i] : 255;
+			auto p = d + ((size_t)j * w + i) * 4;
+			for (int k = 0; k < 3; ++k) {
+				float x = std::clamp(c[k], 0.f, 255.f);
+				if (pm) x = std::round(x) * A / 255.f;
+				p[k] = (uint8_t)std::lround(x);
+			}
+			p[3] = (uint8_t)A;
+		}
+	}
+}
+
+int main() {
+	std::mt19937 rng(1);
+	int maxDiff{};
+	size_t mismatches{};
+	for (int it = 0; it < 300; ++it) {
+		uint32_t w = 1 + rng() % 300, h = 1 + rng() % 40, ys = (w + 31) & ~31, us = (((w + 1) / 2) + 31) & ~31;
+		std::vector<uint8_t> Y(ys * h), U(us * ((h + 1) / 2)), V(U.size()), A(Y.size());
+		for (auto& x : Y) x = (uint8_t)rng();
+		for (auto& x : U) x = (uint8_t)rng();
+		for (auto& x : V) x = (uint8_t)rng();
+		for (auto& x : A) x = (uint8_t)rng();
+		for (int pm = 0; pm < 2; ++pm) {
+			for (int noAlpha = 0; noAlpha < 2; ++noAlpha) {
+				auto ap = noAlpha ? nullptr : A.data();
+				std::vector<uint8_t> r(w * h * 4), s(w * h * 4), f(w * h * 4);
+				xx::YuvaToRgba(r.data(), 0, w, h, Y.data(), U.data(), V.data(), ap, ys, us, pm);
+				xx::YuvaToRgba_Scalar(s.data(), 0, w, h, Y.data(), U.data(), V.data(), ap, ys, us, pm);
+				YuvaToRgba_Float(f.data(), w, h, Y.data(), U.data(), V.data(), ap, ys, us, pm);
+				if (r != s) ++mismatches;
+				for (size_t i = 0; i < f.size(); ++i) {
+					maxDiff = std::max(maxDiff, std::abs(s[i] - f[i]));
+				}
+			}
+		}
+	}
+	xx::CoutN("simd != scalar cases: ", mismatches, ", max diff to float formula: ", maxDiff);
+
+	uint32_t w = 1920, h = 1080, ys = 1920, us = 960;
+	std::vector<uint8_t> Y(ys * h), U(us * h / 2), V(U.size()), A(Y.size()), D(w * h * 4);
+	for (auto& x : Y) x = (uint8_t)rng();
+	for (auto& x : U) x = (uint8_t)rng();
+	for (auto& x : V) x = (uint8_t)rng();
+	for (auto& x : A) x = (uint8_t)rng();
+	for (std::string_view name : { "scalar", "simd", "simd premultiply" }) {
+		int n = 50;
+		auto secs = xx::NowEpochSeconds();
+		for (int i = 0; i < n; ++i) {
+			if (name == "scalar") {
+				xx::YuvaToRgba_Scalar(D.data(), 0, w, h, Y.data(), U.data(), V.data(), A.data(), ys, us, false);
+			} else {
+				xx::YuvaToRgba(D.data(), 0, w, h, Y.data(), U.data(), V.data(), A.data(), ys, us, name != "simd");
+			}
+		}
+		secs = xx::NowEpochSeconds(secs);
+		xx::CoutN(name, ": ", (double)w * h * n / secs / 1000000, " MP/s");
+	}
+	return mismatches || maxDiff > 1 ? 1 : 0;
+}
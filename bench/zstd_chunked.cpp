@@ -0,0 +1,25 @@
+﻿#include "xx2d.h"
+
+// chunked zstd container: compress 200 MB ( compressible, not trivial ), then decompress by 1, 2, 4 ... threads, and hardware_concurrency even when it is not a power of 2
+
+int main() {
+	xx::Data raw, z, tmp;
+	raw.Resize(200 * 1024 * 1024);
+	xx::SmallRnd rnd(1);
+	for (size_t i = 0; i < raw.len; ++i) {
+		raw[i] = (uint8_t)(i / 4096 + rnd.NextBounded(4));
+	}
+	auto secs = xx::NowEpochSeconds();
+	xx::ZstdCompressChunked(raw, z);
+	xx::CoutN("raw = ", raw.len, " chunked = ", z.len, " compress secs = ", xx::NowEpochSeconds(secs));
+	for (size_t n = 1, e = std::max(1u, std::thread::hardware_concurrency()); n <= e; n = n < e && n * 2 > e ? e : n * 2) {	// last step clamps to e ( 6, 12, 24 cores )
+		secs = xx::NowEpochSeconds();
+		xx::ZstdDecompressChunked(z, tmp, n);
+		xx::CoutN("threads = ", n, " decompress secs = ", xx::NowEpochSeconds(secs));
+		if (tmp != raw) {
+			xx::CoutN("round trip failed");
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,54 @@
+﻿#include "xx2d.h"
+
+// zstd level 19 with & without a trained dictionary: total size & decompress time of small ( <= 64 KB ) files in res/. run at repo root
+// the dictionary is trained on even-indexed files and measured on the odd-indexed ( held-out ) ones: gains are not memorised content
+
+int main() {
+	xx::engine.Init();
+	std::vector<xx::Data> srcs;
+	for (auto&& e : std::filesystem::recursive_directory_iterator("res")) {
+		if (!e.is_regular_file() || e.file_size() > 64 * 1024) continue;
+		srcs.push_back(xx::engine.LoadFileDataWithFullPath(e.path().string(), false));
+	}
+	std::sort(srcs.begin(), srcs.end(), [](auto const& a, auto const& b) { return a.len < b.len; });	// similar size mix on both sides
+	std::vector<std::string_view> trains, samples;
+	std::vector<xx::Data> tests;
+	for (size_t i = 0; i < srcs.size(); ++i) {
+		if (i & 1) {
+			tests.push_back(std::move(srcs[i]));
+		} else {
+			trains.emplace_back((char*)srcs[i].buf, srcs[i].len);
+		}
+	}
+	for (auto& d : tests) samples.emplace_back((char*)d.buf, d.len);
+
+	xx::Data dict, tmp;
+	xx::ZstdTrainDict(trains, dict);
+	xx::ZstdDictAdd(dict);
+
+	std::vector<xx::Data> zs(tests.size()), zds(tests.size());
+	size_t rawLen{}, zsLen{}, zdsLen{};
+	for (size_t i = 0; i < tests.size(); ++i) {
+		xx::ZstdCompress(samples[i], zs[i], 19);
+		xx::ZstdCompress(samples[i], zds[i], 19, dict);
+		rawLen += tests[i].len;
+		zsLen += zs[i].len;
+		zdsLen += zds[i].len;
+	}
+	xx::CoutN("train files = ", trains.size(), " held-out files = ", tests.size(), " raw size = ", rawLen, " zstd size = ", zsLen, " zstd + dict size = ", zdsLen, " ( + dict ", dict.len, " )");
+
+	auto secs = xx::NowEpochSeconds();
+	for (int n = 0; n < 1000; ++n) for (auto& z : zs) xx::ZstdDecompress(z, tmp);
+	xx::CoutN("1000 rounds no dict secs = ", xx::NowEpochSeconds(secs));
+	for (int n = 0; n < 1000; ++n) for (auto& z : zds) xx::ZstdDecompress(z, tmp);
+	xx::CoutN("1000 rounds dict secs = ", xx::NowEpochSeconds(secs));
+
+	for (size_t i = 0; i < tests.size(); ++i) {
+		xx::ZstdDecompress(zds[i], tmp);
+		if (tmp != tests[i]) {
+			xx::CoutN("round trip failed: file index ", i);
+			return 1;
+		}
+	}
+	return 0;
+}
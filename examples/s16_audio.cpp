@@ -26,6 +26,11 @@ namespace AudioTest {
 		btns.emplace_back().Init(this, { 0, y }, 5, "play 5.ogg", 32);
 		btns.emplace_back().Init(this, { xstep, y }, 6, "play 6.ogg", 32);
 
+		// decode sfx once. Play will not touch file & decoder
+		for (int i = 1; i <= 6; ++i) {
+			audio.Load(xx::ToString("res/", i, ".ogg"));
+		}
+
 	}
 
 	int Scene::Update() {
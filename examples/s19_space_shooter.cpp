@@ -496,6 +496,10 @@ namespace SpaceShooter {
 		// play bg music
 		audio.PlayBG("res/bg.ogg");
 
+		// preload sfx
+		audio.Load("res/1.ogg");
+		audio.Load("res/3.ogg");
+
 		// run script
 		coros.Add(SceneLogic());
 	}
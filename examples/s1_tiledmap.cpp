@@ -52,11 +52,11 @@ namespace TiledMap {
 
 		// func for make sprites
 		auto&& MakeSprites = [&](Layer_SAs& lsas) {
-			lsas.sas.resize(lsas.layer->gids.size());
+			lsas.sas.resize((size_t)map.width * map.height);
 			for (int cy = 0; cy < (int)map.height; ++cy) {
 				for (int cx = 0; cx < (int)map.width; ++cx) {
 					auto&& idx = cy * (int)map.width + cx;
-					auto&& gid = lsas.layer->gids[idx];
+					auto&& gid = lsas.layer->GetGid(cx, cy);
 					if (!gid) continue;
 
 					auto& sa = lsas.sas[idx];
@@ -78,13 +78,14 @@ namespace TiledMap {
 		MakeSprites(layerTrees);
 
 		// fill wall flags
-		auto&& bgGids = layerBG.layer->gids;
-		auto&& numGids = bgGids.size();
-		walls.resize(numGids);
-		for (size_t i = 0; i < numGids; ++i) {
-			assert(bgGids[i]);
-			if (auto&& tile = map.gidInfos[bgGids[i]].tile) {
-				walls[i] = tile->class_ == "w"sv;
+		walls.resize((size_t)map.width * map.height);
+		for (uint32_t y = 0; y < map.height; ++y) {
+			for (uint32_t x = 0; x < map.width; ++x) {
+				auto&& gid = layerBG.layer->GetGid(x, y);
+				assert(gid);
+				if (auto&& tile = map.gidInfos[gid].tile) {
+					walls[y * map.width + x] = tile->class_ == "w"sv;
+				}
 			}
 		}
 
@@ -15,7 +15,7 @@ namespace TiledMap {
 
 	struct Layer_SAs {
 		xx::TMX::Layer_Tile* layer{};
-		// mapping to layer.gids
+		// mapping to layer cells: [ y * map.width + x ]
 		std::vector<Sprite_Anim> sas;
 	};
 
@@ -8,9 +8,6 @@ namespace XxmvTest {
 		int Update() override;
 
 		xx::Mv mv;
-		xx::Quad spr;
-		std::vector<xx::Shared<xx::GLTexture>> texs;
-		int cursor{};
-		float timePool{};
+		xx::MvPlayer player;
 	};
 }
@@ -13,6 +13,15 @@ namespace xx {
 		return f;
 	}
 
+	AnimFrames MakeAnimFrames(std::vector<Shared<Frame>> const& fs, float const& durationSeconds) {
+		AnimFrames afs;
+		afs.reserve(fs.size());
+		for (auto& f : fs) {
+			afs.push_back({ f, durationSeconds });
+		}
+		return afs;
+	}
+
 	AnimFrame& Anim::GetCurrentAnimFrame() const {
 		return (AnimFrame&)afs[cursor];
 	}
@@ -28,6 +28,9 @@ namespace xx {
 
     using AnimFrames = std::vector<AnimFrame>;
 
+    // same duration for every frame ( TP::GetByPrefix's result, baked Mv clip ... )
+    AnimFrames MakeAnimFrames(std::vector<Shared<Frame>> const& fs, float const& durationSeconds);
+
     struct Anim {
         AnimFrames afs;
         size_t cursor{};
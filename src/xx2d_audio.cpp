@@ -11,79 +11,550 @@
 #undef L
 #undef C
 #undef R
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #endif
 
 namespace xx {
 
-	Audio::Audio() {
+#ifdef XX2D_ENABLE_MINIAUDIO
+	// bg music's source for resource manager's streaming decoder ( it reads a page ( ~1 sec ) ahead, never decode whole file )
+	// plain file: mmap ( os pages in on demand ). zstd / chunked zstd: decompress the container once ( still encoded ogg / mp3 ... )
+	struct AudioVfsFile {
+		xx::Data d;
+		uint8_t const* buf{};		// d.buf or mapped memory
+		size_t len{}, cursor{};
+		bool mapped{};
+
+		~AudioVfsFile() {
+			Unmap();
+		}
+
+		void Unmap() {
+			if (!mapped) return;
+#ifdef _WIN32
+			UnmapViewOfFile(buf);
+#else
+			munmap((void*)buf, len);
+#endif
+			mapped = false;
+			buf = {};
+			len = {};
+		}
+
+		// memory held by this file: decompressed container's buffer, or mapped pages which are resident now
+		size_t GetMemorySize() const {
+			if (!mapped) return d.cap;
+#ifdef _WIN32
+			return len;
+#else
+			auto ps = (size_t)sysconf(_SC_PAGESIZE);
+			std::vector<unsigned char> vec((len + ps - 1) / ps);
+			if (mincore((void*)buf, len, vec.data())) return len;
+			size_t n{};
+			for (auto& v : vec) {
+				n += v & 1;
+			}
+			return n * ps;
+#endif
+		}
+
+		// return false: open / map failed or empty
+		bool Map(char const* fp) {
+#ifdef _WIN32
+			auto h = CreateFileA(fp, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (h == INVALID_HANDLE_VALUE) return false;
+			LARGE_INTEGER siz;
+			if (!GetFileSizeEx(h, &siz) || !siz.QuadPart) {
+				CloseHandle(h);
+				return false;
+			}
+			auto m = CreateFileMappingA(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			CloseHandle(h);
+			if (!m) return false;
+			auto p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(m);
+			if (!p) return false;
+			len = (size_t)siz.QuadPart;
+#else
+			auto fd = open(fp, O_RDONLY);
+			if (fd == -1) return false;
+			struct stat st;
+			if (fstat(fd, &st) || !st.st_size) {
+				close(fd);
+				return false;
+			}
+			auto p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			close(fd);
+			if (p == MAP_FAILED) return false;
+			len = (size_t)st.st_size;
+#endif
+			buf = (uint8_t const*)p;
+			mapped = true;
+			return true;
+		}
+	};
+
+	struct AudioVfs {
+		ma_vfs_callbacks cb{};		// must be the first member
+		std::mutex mtx;
+		std::vector<AudioVfsFile*> files;	// opened ( by resource manager's job thread ), guard by mtx. for GetMemorySize
+
+		size_t GetMemorySize() {
+			std::scoped_lock<std::mutex> g(mtx);
+			size_t n{};
+			for (auto& f : files) {
+				n += f->GetMemorySize();
+			}
+			return n;
+		}
+
+		AudioVfs() {
+			cb.onOpen = [](ma_vfs* vfs, const char* fp, ma_uint32 mode, ma_vfs_file* pf)->ma_result {
+				if (!fp || !pf) return MA_INVALID_ARGS;
+				*pf = {};
+				if (mode & MA_OPEN_MODE_WRITE) return MA_INVALID_ARGS;
+				auto f = new AudioVfsFile{};
+				if (!f->Map(fp)) {
+					delete f;
+					return MA_DOES_NOT_EXIST;
+				}
+				std::string_view sv((char const*)f->buf, f->len);
+				bool isZstd = f->len >= 4 && f->buf[0] == 0x28 && f->buf[1] == 0xB5 && f->buf[2] == 0x2F && f->buf[3] == 0xFD;
+				if (isZstd || IsZstdChunked(sv)) {
+					try {
+						if (isZstd) {
+							ZstdDecompress(sv, f->d);
+						} else {
+							ZstdDecompressChunked(sv, f->d, 1);
+						}
+					} catch (...) {
+						delete f;
+						return MA_ERROR;
+					}
+					f->Unmap();
+					f->buf = f->d.buf;
+					f->len = f->d.len;
+				}
+				{
+					auto self = (AudioVfs*)vfs;
+					std::scoped_lock<std::mutex> g(self->mtx);
+					self->files.push_back(f);
+				}
+				*pf = f;
+				return MA_SUCCESS;
+			};
+			cb.onClose = [](ma_vfs* vfs, ma_vfs_file f)->ma_result {
+				{
+					auto self = (AudioVfs*)vfs;
+					std::scoped_lock<std::mutex> g(self->mtx);
+					std::erase(self->files, (AudioVfsFile*)f);
+				}
+				delete (AudioVfsFile*)f;
+				return MA_SUCCESS;
+			};
+			cb.onRead = [](ma_vfs*, ma_vfs_file pf, void* dst, size_t siz, size_t* pRead)->ma_result {
+				auto f = (AudioVfsFile*)pf;
+				auto n = std::min(siz, f->len - f->cursor);
+				memcpy(dst, f->buf + f->cursor, n);
+				f->cursor += n;
+				if (pRead) *pRead = n;
+				return n || !siz ? MA_SUCCESS : MA_AT_END;
+			};
+			cb.onSeek = [](ma_vfs*, ma_vfs_file pf, ma_int64 offset, ma_seek_origin origin)->ma_result {
+				auto f = (AudioVfsFile*)pf;
+				ma_int64 base = origin == ma_seek_origin_start ? 0 : origin == ma_seek_origin_current ? (ma_int64)f->cursor : (ma_int64)f->len;
+				auto p = base + offset;
+				if (p < 0 || p > (ma_int64)f->len) return MA_INVALID_ARGS;
+				f->cursor = (size_t)p;
+				return MA_SUCCESS;
+			};
+			cb.onTell = [](ma_vfs*, ma_vfs_file pf, ma_int64* pCursor)->ma_result {
+				*pCursor = (ma_int64)((AudioVfsFile*)pf)->cursor;
+				return MA_SUCCESS;
+			};
+			cb.onInfo = [](ma_vfs*, ma_vfs_file pf, ma_file_info* pInfo)->ma_result {
+				pInfo->sizeInBytes = ((AudioVfsFile*)pf)->len;
+				return MA_SUCCESS;
+			};
+		}
+	};
+
+	struct AudioVoice {
+		ma_sound sound;
+		ma_audio_buffer_ref ref;	// point to AudioSound's frames
+		AudioSound* s{};			// != nullptr: sound inited
+		uint64_t serial{};			// start order. small == old
+		int priority{};
+		uint8_t group{};
+
+		bool IsPlaying() const {
+			return s && ma_sound_is_playing(&sound);
+		}
+
+		// lower priority first, then older
+		bool StealBefore(AudioVoice const* o) const {
+			return !o || priority < o->priority || (priority == o->priority && serial < o->serial);
+		}
+	};
+#endif
+
+	AudioSound::~AudioSound() {
+#ifdef XX2D_ENABLE_MINIAUDIO
+		if (frames) {
+			ma_free(frames, nullptr);
+			frames = {};
+		}
+#endif
+	}
+
+	Audio::Audio(AudioModes const& mode_, size_t const& numVoices, uint32_t const& sampleRate, uint32_t const& channels_) {
 		cd = 0.1;
+		mode = mode_;
 #ifdef XX2D_ENABLE_MINIAUDIO
+		auto cfg = ma_engine_config_init();
+		if (mode == AudioModes::Offline) {
+			cfg.noDevice = MA_TRUE;
+			cfg.channels = channels_;
+			cfg.sampleRate = sampleRate;
+		} else if (mode == AudioModes::NullDevice) {
+			maCtx = malloc(sizeof(ma_context));
+			ma_backend backends[] = { ma_backend_null };
+			if (auto result = ma_context_init(backends, 1, nullptr, (ma_context*)maCtx); result != MA_SUCCESS) {
+				free(maCtx);
+				maCtx = {};
+				throw std::logic_error("Failed to initialize audio null backend.");
+			}
+			cfg.pContext = (ma_context*)maCtx;
+		}
+		auto sg = xx::MakeScopeGuard([this] {	// ctor throw: dtor won't run
+			free(ctx);
+			ctx = {};
+			delete (AudioVfs*)vfs;
+			vfs = {};
+			if (maCtx) {
+				ma_context_uninit((ma_context*)maCtx);
+				free(maCtx);
+				maCtx = {};
+			}
+		});
+		vfs = new AudioVfs{};
+		cfg.pResourceManagerVFS = vfs;
 		ctx = malloc(sizeof(ma_engine));
-		if (auto result = ma_engine_init(nullptr, (ma_engine*)ctx); result != MA_SUCCESS) {
+		if (auto result = ma_engine_init(&cfg, (ma_engine*)ctx); result != MA_SUCCESS) {
 			throw std::logic_error("Failed to initialize audio engine.");
 		}
+		sg.Cancel();
+		auto channels = ma_engine_get_channels((ma_engine*)ctx);
+		voices.resize(numVoices);
+		for (auto& p : voices) {
+			auto v = new AudioVoice{};
+			ma_audio_buffer_ref_init(ma_format_f32, channels, nullptr, 0, &v->ref);
+			p = v;
+		}
 #endif
+		worker = std::thread([this] {
+			while (true) {
+				if (auto c = cmds.Peek()) {
+					if (c->type == AudioCmdTypes::Quit) return;
+					Handle(*c);
+					cmds.Pop();
+				} else {
+					cmds.WaitPush();
+				}
+			}
+		});
 	}
 
 	Audio::~Audio() {
+		while (!cmds.Push({ AudioCmdTypes::Quit })) {
+			std::this_thread::yield();
+		}
+		worker.join();
 #ifdef XX2D_ENABLE_MINIAUDIO
-		tp.Join();
 		if (bg) {
 			ma_sound_uninit((ma_sound*)bg);
 			free(bg);
 			bg = {};
 		}
+		for (auto& p : voices) {
+			auto v = (AudioVoice*)p;
+			if (v->s) {
+				ma_sound_uninit(&v->sound);
+			}
+			ma_audio_buffer_ref_uninit(&v->ref);
+			delete v;
+		}
+		voices.clear();
+		sounds.clear();
 		ma_engine_uninit((ma_engine*)ctx);
 		free(ctx);
 		ctx = {};
+		delete (AudioVfs*)vfs;
+		vfs = {};
+		if (maCtx) {
+			ma_context_uninit((ma_context*)maCtx);
+			free(maCtx);
+			maCtx = {};
+		}
+#endif
+	}
+
+	bool Audio::StopBG() {
+		return cmds.Push({ AudioCmdTypes::StopBG });
+	}
+
+	bool Audio::PlayBG(std::string_view const& fn) {
+		auto iter = bgs.find(fn);
+		if (iter == bgs.end()) {
+			auto s = xx::Make<AudioSound>();
+			s->fn = xx::engine.GetFullPath(fn);
+			if (s->fn.empty()) throw std::logic_error("fn can't find: " + std::string(fn));
+			iter = bgs.emplace(std::string(fn), std::move(s)).first;
+		}
+		return cmds.Push({ AudioCmdTypes::PlayBG, iter->second.pointer });
+	}
+
+	void Audio::HandleStopBG() {
+#ifdef XX2D_ENABLE_MINIAUDIO
+		if (bg) {
+			ma_sound_uninit((ma_sound*)bg);
+			free(bg);
+			bg = {};
+		}
 #endif
 	}
 
-	void Audio::StopBG() {
+	void Audio::HandlePlayBG(AudioSound* s) {
 #ifdef XX2D_ENABLE_MINIAUDIO
-		tp.Add([this] {
-			if (bg) {
-				ma_sound_uninit((ma_sound*)bg);
-				free(bg);
-				bg = {};
+		if (bg) {
+			ma_sound_uninit((ma_sound*)bg);
+		} else {
+			bg = malloc(sizeof(ma_sound));
+		}
+		// stream: decode page by page on resource manager's job thread, file bytes come from AudioVfs
+		if (auto result = ma_sound_init_from_file((ma_engine*)ctx, s->fn.c_str(), MA_SOUND_FLAG_STREAM, nullptr, nullptr, (ma_sound*)bg); result != MA_SUCCESS) {
+			xx::CoutN("Failed to init sound file. result = ", result, " fn = ", s->fn);
+			free(bg);
+			bg = {};
+			return;
+		}
+		ma_sound_start((ma_sound*)bg);
+#endif
+	}
+
+	void Audio::Handle(AudioCmd const& c) {
+		switch (c.type) {
+		case AudioCmdTypes::Play:
+			HandlePlay(c.s);
+			break;
+		case AudioCmdTypes::PlayBG:
+			HandlePlayBG(c.s);
+			break;
+		case AudioCmdTypes::StopBG:
+			HandleStopBG();
+			break;
+		default:
+			break;
+		}
+	}
+
+	void Audio::Flush() {
+		cmds.WaitEmpty();
+	}
+
+	xx::Shared<AudioSound> const& Audio::Load(std::string_view const& fn) {
+		if (auto iter = sounds.find(fn); iter != sounds.end()) return iter->second;
+		auto [d, fp] = xx::engine.LoadFileData(fn);
+		if (!d) throw std::logic_error(xx::ToString("read sound file failed. fn = ", fn));
+		auto s = xx::Make<AudioSound>();
+		s->fn = std::move(fp);
+#ifdef XX2D_ENABLE_MINIAUDIO
+		auto eng = (ma_engine*)ctx;
+		auto cfg = ma_decoder_config_init(ma_format_f32, ma_engine_get_channels(eng), ma_engine_get_sample_rate(eng));
+		if (auto result = ma_decode_memory(d.buf, d.len, &cfg, &s->frameCount, &s->frames); result != MA_SUCCESS) {
+			throw std::logic_error(xx::ToString("Failed to decode sound file. result = ", result, " fn = ", s->fn));
+		}
+#endif
+		s->owner = this;
+		return sounds.emplace(std::string(fn), std::move(s)).first->second;
+	}
+
+	void Audio::Unload(std::string_view const& fn) {
+		auto iter = sounds.find(fn);
+		if (iter == sounds.end()) return;
+		Flush();
+#ifdef XX2D_ENABLE_MINIAUDIO
+		for (auto& p : voices) {
+			auto v = (AudioVoice*)p;
+			if (v->s == iter->second.pointer) {
+				ma_sound_uninit(&v->sound);
+				v->s = {};
 			}
-		});
+		}
 #endif
+		iter->second->owner = {};
+		sounds.erase(iter);
+	}
+
+	void Audio::UnloadAll() {
+		Flush();
+#ifdef XX2D_ENABLE_MINIAUDIO
+		for (auto& p : voices) {
+			auto v = (AudioVoice*)p;
+			if (v->s) {
+				ma_sound_uninit(&v->sound);
+				v->s = {};
+			}
+		}
+#endif
+		for (auto& kv : sounds) {
+			kv.second->owner = {};
+		}
+		sounds.clear();
+	}
+
+	bool Audio::Play(std::string_view const& fn) {
+		auto iter = sounds.find(fn);
+		assert(iter != sounds.end());	// Load it first: decode on game thread is not a trigger's job
+		if (iter == sounds.end()) return false;
+		return Play(iter->second);
+	}
+
+	bool Audio::Play(xx::Shared<AudioSound> const& s) {
+		if (s->owner != this) return false;	// voices & commands keep raw pointer: only bank items ( Unload unbind them ) are safe
+		if (s->cdTo > xx::engine.nowSecs) return false;
+		if (!s->frames) return false;
+		assert(s->group < groups.size());
+		if (s->group >= groups.size()) return false;
+		if (!cmds.Push({ AudioCmdTypes::Play, s.pointer })) {
+			++dropCount;
+			return false;
+		}
+		s->cdTo = xx::engine.nowSecs + (s->cd < 0 ? cd : s->cd);
+		return true;
 	}
 
-	void Audio::PlayBG(std::string_view const& fn) {
-		auto s = xx::engine.GetFullPath(fn);
+	void Audio::HandlePlay(AudioSound* s) {
 #ifdef XX2D_ENABLE_MINIAUDIO
-		tp.Add([this, s = std::move(s)] {
-			if (bg) {
-				ma_sound_uninit((ma_sound*)bg);
-			} else {
-				bg = malloc(sizeof(ma_sound));
+		auto gi = s->group;	// read once: lookup & count must use the same group
+		if (gi >= groups.size()) {
+			++dropCount;
+			return;
+		}
+		auto& g = groups[gi];
+
+		// one pass: count instances & pick candidates. cost is bounded by voices.size()
+		AudioVoice* idle{}, * oldestSame{}, * groupVictim{}, * victim{};
+		uint32_t sameCount{}, groupCount{};
+		for (auto& p : voices) {
+			auto o = (AudioVoice*)p;
+			if (!o->IsPlaying()) {
+				if (!idle || o->s == s) {	// prefer the one already bound to s ( no re-init )
+					idle = o;
+				}
+				continue;
 			}
-			auto result = ma_sound_init_from_file((ma_engine*)ctx, s.c_str(), 0, nullptr, nullptr, (ma_sound*)bg);
-			if (result != MA_SUCCESS) {
-				throw std::logic_error(xx::ToString("Failed to init sound file. result = ", result, " fn = ", s));
+			if (o->s == s) {
+				++sameCount;
+				if (!oldestSame || o->serial < oldestSame->serial) {
+					oldestSame = o;
+				}
 			}
-			ma_sound_start((ma_sound*)bg);
-		});
+			if (o->group == gi) {
+				++groupCount;
+				if (o->StealBefore(groupVictim)) {
+					groupVictim = o;
+				}
+			}
+			if (o->StealBefore(victim)) {
+				victim = o;
+			}
+		}
+
+		AudioVoice* v{};
+		if (s->maxInstances && sameCount >= s->maxInstances) {
+			v = oldestSame;
+		} else if (g.maxVoices && groupCount >= g.maxVoices) {
+			if (groupVictim && groupVictim->priority <= s->priority) {
+				v = groupVictim;
+			}
+		} else if (idle) {
+			v = idle;
+		} else if (victim && victim->priority <= s->priority) {
+			v = victim;
+		}
+		if (!v) {
+			++dropCount;
+			return;
+		}
+		if (v->IsPlaying()) {
+			ma_sound_stop(&v->sound);
+			++stealCount;
+		}
+
+		if (v->s == s) {
+			ma_sound_seek_to_pcm_frame(&v->sound, 0);
+		} else {
+			if (v->s) {
+				ma_sound_uninit(&v->sound);
+				v->s = {};
+			}
+			ma_audio_buffer_ref_set_data(&v->ref, s->frames, s->frameCount);
+			if (auto result = ma_sound_init_from_data_source((ma_engine*)ctx, &v->ref, 0, nullptr, &v->sound); result != MA_SUCCESS) {
+				++dropCount;
+				return;
+			}
+			v->s = s;
+		}
+		v->serial = ++voiceSerial;
+		v->priority = s->priority;
+		v->group = gi;
+		ma_sound_start(&v->sound);
+		++playCount;
 #endif
 	}
 
-	void Audio::Play(std::string_view const& fn) {
-		auto s = xx::engine.GetFullPath(fn);
+	uint64_t Audio::Mix(float* out, uint64_t const& frameCount) {
+		if (mode != AudioModes::Offline) throw std::logic_error("Mix: Audio mode must be Offline");
+		Flush();
+		uint64_t n{};
 #ifdef XX2D_ENABLE_MINIAUDIO
-		tp.Add([this, s = std::move(s)] {
-			for (int i = (int)fncds.size() - 1; i >= 0; --i) {
-				auto& pair = fncds[i];
-				if (pair.second <= xx::engine.nowSecs) {
-					pair = fncds.back();
-					fncds.pop_back();
-				} else if (pair.first == s) return;
-			}
-			ma_engine_play_sound((ma_engine*)ctx, s.c_str(), nullptr);
-			fncds.emplace_back(std::move(s), xx::engine.nowSecs + cd);
-		});
+		ma_engine_read_pcm_frames((ma_engine*)ctx, out, frameCount, &n);
 #endif
+		return n;
 	}
 
+	size_t Audio::GetBGMemorySize() {
+		Flush();
+		size_t n{};
+#ifdef XX2D_ENABLE_MINIAUDIO
+		n += ((AudioVfs*)vfs)->GetMemorySize();
+		if (bg) {
+			ma_format fmt;
+			ma_uint32 ch, sr;
+			if (ma_sound_get_data_format((ma_sound*)bg, &fmt, &ch, &sr, nullptr, 0) == MA_SUCCESS) {
+				n += 2 * (MA_RESOURCE_MANAGER_PAGE_SIZE_IN_MILLISECONDS * (size_t)sr / 1000) * ma_get_bytes_per_frame(fmt, ch);	// data stream's 2 pages
+			}
+		}
+#endif
+		return n;
+	}
+
+	size_t Audio::GetPlayingCount() {
+		Flush();
+		size_t n{};
+#ifdef XX2D_ENABLE_MINIAUDIO
+		for (auto& p : voices) {
+			if (((AudioVoice*)p)->IsPlaying()) {
+				++n;
+			}
+		}
+#endif
+		return n;
+	}
 }
@@ -3,21 +3,113 @@
 
 namespace xx {
 
+	struct Audio;
+
+	// decoded pcm ( engine's format: f32, engine's channels & sample rate ). voices read it directly, no file io & decode when play
+	struct AudioSound {
+		std::string fn;				// full path
+		void* frames{};				// alloc by ma_decode_memory
+		uint64_t frameCount{};
+		double cdTo{};				// Play before this time will be ignored
+		Audio* owner{};				// the Audio whose sounds hold it. set by Load, clear by Unload. Play reject others
+
+		// voice manager settings
+		float cd = -1;				// min play interval. < 0: use Audio::cd
+		uint32_t maxInstances = 0;	// max playing voices of this sound. 0: unlimited. reached: steal the oldest instance
+		int priority = 0;			// steal voice which priority <= this ( lowest first, then oldest )
+		uint8_t group = 0;			// index of Audio::groups. >= groups.size(): Play return false
+
+		AudioSound() = default;
+		AudioSound(AudioSound const&) = delete;
+		AudioSound& operator=(AudioSound const&) = delete;
+		~AudioSound();
+	};
+
+	// game thread -> audio thread. POD, no alloc. s: point to bank item ( sounds or bgs )
+	enum class AudioCmdTypes : uint8_t {
+		Quit, Play, PlayBG, StopBG
+	};
+	struct AudioCmd {
+		AudioCmdTypes type;
+		AudioSound* s;
+	};
+
+	enum class AudioModes : uint8_t {
+		Device,			// default playback device
+		NullDevice,		// miniaudio's null backend: real time clock, no sound card ( headless )
+		Offline			// no device: nothing plays until Mix pull frames ( benchmark / render to file )
+	};
+
+	struct AudioGroup {
+		uint32_t maxVoices = 0;			// 0: unlimited. reached: steal in group by priority & age
+	};
+
 	struct Audio {
-		void* ctx{}, * bg{};
+		void* ctx{}, * bg{}, * maCtx{};	// ma_engine*, ma_sound*, ma_context*( NullDevice only )
+		AudioModes mode{};
+		void* vfs{};					// AudioVfs*: mmap / zstd file source for streamed bg music
 
-		double cd{};
-		std::vector<std::pair<std::string, double>> fncds;
+		double cd{};					// same sound's min play interval
+		std::array<AudioGroup, 8> groups;
 
-		// todo: file cache? maybe need it?
+		// stats. write by audio thread ( dropCount: queue full also )
+		std::atomic<uint64_t> playCount{}, stealCount{}, dropCount{};
 
-		xx::ThreadPool<> tp{ 1 };
+		// sound bank. key: Play / Load's fn
+		std::unordered_map<std::string, xx::Shared<AudioSound>, xx::StringHasher<>, std::equal_to<void>> sounds;
 
-		Audio();
+		// bg music bank ( fn only, no pcm ). key: PlayBG's fn
+		std::unordered_map<std::string, xx::Shared<AudioSound>, xx::StringHasher<>, std::equal_to<void>> bgs;
+
+		// fixed sound instances ( AudioVoice* ). preallocate by ctor. re-init only when bind to another sound. audio thread only
+		std::vector<void*> voices;
+		uint64_t voiceSerial{};			// for voice's age
+
+		// command channel. game thread never lock or alloc when trigger ( except first PlayBG of a fn )
+		xx::SpscRing<AudioCmd, 1024> cmds;
+		std::thread worker;
+
+		// numVoices: max concurrent sfx. Offline: sampleRate & channels of Mix's output
+		Audio(AudioModes const& mode = AudioModes::Device, size_t const& numVoices = 32, uint32_t const& sampleRate = 48000, uint32_t const& channels = 2);
 		~Audio();
-		void PlayBG(std::string_view const& fn);
-		void StopBG();
-		void Play(std::string_view const& fn);
+
+		// stream decode fn ( loose or zstd packed ) through vfs. throw when fn can't find. return false: command queue full
+		// memory: pcm 2 pages * 1 sec ( 48k stereo f32: 768 KB ) for any length + encoded bytes: loose file is mapped ( os pages in on demand ),
+		// zstd packed file is decompressed whole at open. decode cpu spread by resource manager's job thread. measured: GetBGMemorySize, bench/audio_mix.cpp
+		bool PlayBG(std::string_view const& fn);
+		bool StopBG();
+
+		// read & decode fn once, then cache. throw when failed
+		xx::Shared<AudioSound> const& Load(std::string_view const& fn);
+
+		// wait pending commands, then stop voices which are playing it & release pcm
+		void Unload(std::string_view const& fn);
+		void UnloadAll();
+
+		// find fn in sounds ( no file io, no decode. miss: assert & return false. Load first ) & post a play command. voice select / steal happen on audio thread
+		// return false: in cd, or command queue full, or s is not in sounds ( unloaded / not made by Load ), or s->group is out of range. benchmark: bench/audio_trigger.cpp
+		bool Play(std::string_view const& fn);
+		bool Play(xx::Shared<AudioSound> const& s);
+
+		// block until audio thread handled all posted commands
+		void Flush();
+
+		// Flush & count
+		size_t GetPlayingCount();
+
+		// Flush & sum bg music's memory: vfs file buffers ( decompressed container, or resident mapped pages ) + stream's pcm pages
+		size_t GetBGMemorySize();
+
+		// Offline only. Flush, then mix frameCount frames ( f32 interleaved, channels ) into out as fast as possible. return frames read
+		// benchmark: bench/audio_mix.cpp
+		uint64_t Mix(float* out, uint64_t const& frameCount);
+
+	protected:
+		// audio thread
+		void Handle(AudioCmd const& c);
+		void HandlePlay(AudioSound* s);
+		void HandlePlayBG(AudioSound* s);
+		void HandleStopBG();
 	};
 
 }
@@ -25,6 +25,9 @@ namespace xx {
 		// read all data by GetFullPath( fn )
 		std::pair<xx::Data, std::string> LoadFileData(std::string_view const& fn, bool autoDecompress = true);
 
+		// read zstd dictionary file & register it for autoDecompress. return dict id
+		uint32_t LoadZstdDict(std::string_view const& fn);
+
 		/**********************************************************************************/
 		// fonts
 
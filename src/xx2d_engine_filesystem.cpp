@@ -71,6 +71,11 @@ namespace xx {
 				ZstdDecompress(d, d2);
 				return d2;
 			}
+			if (IsZstdChunked(d)) {
+				xx::Data d2;
+				ZstdDecompressChunked(d, d2);
+				return d2;
+			}
 		}
 		return d;
 	}
@@ -83,4 +88,10 @@ namespace xx {
 		return { std::move(d), std::move(p) };
 	}
 
+
+	uint32_t Engine::LoadZstdDict(std::string_view const& fn) {
+		auto [d, p] = LoadFileData(fn, false);
+		return ZstdDictAdd(d);
+	}
+
 }
@@ -9,7 +9,9 @@ namespace xx {
 		if (auto i = p.find_last_of("/"); i != p.npos) {
 			rootPath = p.substr(0, i + 1);
 		}
-		if (auto r = c.Fill(d, rootPath)) throw std::logic_error(xx::ToString("texture packer's plist file fill error. r = ", r, ". file = ", p));
+		if (TP::IsTpb(d)) {
+			if (auto r = c.FillFromTpb(d, rootPath)) throw std::logic_error(xx::ToString("texture packer's tpb file fill error. r = ", r, ". file = ", p));
+		} else if (auto r = c.Fill(d, rootPath)) throw std::logic_error(xx::ToString("texture packer's plist file fill error. r = ", r, ". file = ", p));
 		return c;
 	}
 
@@ -6,34 +6,121 @@ namespace xx {
 
 	int Mv::Load(xx::Data_r d) {
 		Clear();
-		// todo: verify header? version number?
+		if (int r = LoadCore(d, true)) {
+			Clear();
+			return r;
+		}
+		return 0;
+	}
+
+	int Mv::Load(xx::Data&& d) {
+		Clear();
+		data = std::move(d);
+		if (int r = LoadCore(xx::Data_r(data.buf, data.len), false)) {
+			Clear();
+			return r;
+		}
+		return 0;
+	}
+
+	int Mv::LoadView(xx::Data_r const& d) {
+		Clear();
+		if (int r = LoadCore(xx::Data_r(d.buf, d.len), false)) {
+			Clear();
+			return r;
+		}
+		return 0;
+	}
+
+	int Mv::LoadCore(xx::Data_r d, bool const& copy) {
+		uint8_t ver = 1;
+		if (d.len >= magic.size() && memcmp(d.buf, magic.data(), magic.size()) == 0) {
+			d.offset += magic.size();
+			if (int r = d.ReadFixed(ver)) return __LINE__;
+			if (ver == 0 || ver > version) return __LINE__;
+		}
 		if (int r = d.ReadFixed(codecId)) return __LINE__;
 		if (int r = d.ReadFixed(hasAlpha)) return __LINE__;
 		if (int r = d.ReadFixed(width)) return __LINE__;
 		if (int r = d.ReadFixed(height)) return __LINE__;
 		if (int r = d.ReadFixed(duration)) return __LINE__;
+		if (codecId != 1 || hasAlpha > 1 || !width || !height) return __LINE__;	// vp9 only
 		uint32_t siz;
 		if (int r = d.ReadFixed(siz)) return r;
 		if (d.offset + siz * sizeof(uint32_t) > d.len) return __LINE__;
 		lens.resize(siz);
 		if (int r = d.ReadBuf(lens.data(), siz * sizeof(uint32_t))) return __LINE__;
+		if (ver >= 2) {	// key frame table: no need to peek every frame ( LoadView only touch the tables )
+			if (int r = d.ReadFixed(siz)) return __LINE__;
+			if (d.offset + siz * sizeof(uint32_t) > d.len) return __LINE__;
+			keyFrames.resize(siz);
+			if (int r = d.ReadBuf(keyFrames.data(), siz * sizeof(uint32_t))) return __LINE__;
+		}
 		if (int r = d.ReadFixed(siz)) return __LINE__;
 		if (d.offset + siz > d.len) return __LINE__;
-		data.Resize(siz);
-		if (int r = d.ReadBuf(data.buf, data.len)) return __LINE__;
-
+		uint8_t* base;
+		if (copy) {
+			data.Resize(siz);
+			if (int r = d.ReadBuf(data.buf, data.len)) return __LINE__;
+			base = data.buf;
+		} else {
+			base = d.buf + d.offset;
+			d.offset += siz;
+		}
 
+		if (hasAlpha && (lens.size() & 1)) return __LINE__;
 		count = (uint32_t)(hasAlpha ? lens.size() / 2 : lens.size());
+		if (!count) return __LINE__;
+		uint64_t sum = 0;
+		for (auto& len : lens) {
+			sum += len;
+		}
+		if (sum != siz) return __LINE__;
 		bufs.resize(lens.size());
-		auto baseBuf = data.buf;
+		auto baseBuf = base;
 		for (int i = 0; i < lens.size(); ++i) {
-			bufs[i] = (uint8_t*)baseBuf;
+			bufs[i] = baseBuf;
 			baseBuf += lens[i];
 		}
-		if (baseBuf != data.buf + data.len) return __LINE__;
+
+		if (ver >= 2) {
+			for (size_t i = 1; i < keyFrames.size(); ++i) {
+				if (keyFrames[i] <= keyFrames[i - 1]) return __LINE__;
+			}
+			if (!keyFrames.empty() && keyFrames.back() >= count) return __LINE__;
+		} else {
+			for (uint32_t i = 0; i < count; ++i) {
+				if (IsKeyFrame(i)) {
+					keyFrames.push_back(i);
+				}
+			}
+		}
+		if (keyFrames.empty() || keyFrames[0] != 0) return __LINE__;
 		return 0;
 	}
 
+	void Mv::WriteTo(xx::Data& d) const {
+		d.WriteBuf(magic.data(), magic.size());
+		d.WriteFixed(version);
+		d.WriteFixed(codecId);
+		d.WriteFixed(hasAlpha);
+		d.WriteFixed(width);
+		d.WriteFixed(height);
+		d.WriteFixed(duration);
+		d.WriteFixed((uint32_t)lens.size());
+		d.WriteBuf(lens.data(), lens.size() * sizeof(uint32_t));
+		d.WriteFixed((uint32_t)keyFrames.size());
+		d.WriteBuf(keyFrames.data(), keyFrames.size() * sizeof(uint32_t));
+		uint32_t siz = 0;
+		for (auto& len : lens) {
+			siz += len;
+		}
+		d.WriteFixed(siz);
+		for (size_t i = 0; i < lens.size(); ++i) {
+			d.WriteBuf(bufs[i], lens[i]);
+		}
+	}
+
 	Mv::operator bool() const {
 		return count != 0;
 	}
@@ -49,6 +136,7 @@ namespace xx {
 
 		bufs.clear();
 		count = 0;
+		keyFrames.clear();
 	}
 
 	int Mv::GetFrameBuf(uint32_t const& idx, uint8_t const*& rgbBuf, uint32_t& rgbBufLen) const {
@@ -70,61 +158,389 @@ namespace xx {
 		return 0;
 	}
 
-	int Mv::ForeachFrame(YuvaHandler const& h) const {
+	// decode rgb stream on caller thread. alpha stream decode by a worker thread when parallel, join per frame
+	struct MvDecoder {
+		Mv const& mv;
+		vpx_codec_ctx_t ctx, ctxAlpha;
+		bool inited = false;
+		vpx_image_t* imgRGB = nullptr, * imgA = nullptr;	// fill by Decode
 
-		vpx_codec_ctx_t ctx;
-		vpx_codec_dec_cfg_t cfg{ 1, this->width, this->height };
-		assert(this->codecId); //auto&& iface = this->codecId ? vpx_codec_vp9_dx() : vpx_codec_vp8_dx();
-		auto&& iface = vpx_codec_vp9_dx();
-		if (int r = vpx_codec_dec_init(&ctx, iface, &cfg, 0)) return __LINE__;	// VPX_CODEC_OK == 0
-		auto sgCtx = MakeScopeGuard([&] {
-			vpx_codec_destroy(&ctx);
-			});
+		std::thread worker;
+		std::mutex mtx;
+		std::condition_variable cv;
+		uint8_t const* aBuf = nullptr;
+		uint32_t aBufLen = 0;
+		int aResult = 0;
+		int state = 0;	// 0: idle  1: job posted  2: job done  -1: stop
 
-		uint8_t const* rgbBuf = nullptr, * aBuf = nullptr;
-		uint32_t rgbBufLen = 0, aBufLen = 0;
+		MvDecoder(Mv const& mv_) : mv(mv_) {}
+		MvDecoder(MvDecoder const&) = delete;
+		MvDecoder& operator=(MvDecoder const&) = delete;
 
-		if (this->hasAlpha) {
-			vpx_codec_ctx_t ctxAlpha;
-			if (int r = vpx_codec_dec_init(&ctxAlpha, iface, &cfg, 0)) return __LINE__;
-			auto sgCtxAlpha = MakeScopeGuard([&] {
+		~MvDecoder() {
+			if (worker.joinable()) {
+				{
+					std::scoped_lock<std::mutex> g(mtx);
+					state = -1;
+				}
+				cv.notify_all();
+				worker.join();
+			}
+			Destroy();
+		}
+
+		void Destroy() {
+			if (!inited) return;
+			vpx_codec_destroy(&ctx);
+			if (mv.hasAlpha) {
 				vpx_codec_destroy(&ctxAlpha);
-				});
+			}
+			inited = false;
+		}
+
+		// create ( or re-create for restart at key frame ) codec contexts
+		int Reset() {
+			Destroy();
+			assert(mv.codecId); //auto&& iface = mv.codecId ? vpx_codec_vp9_dx() : vpx_codec_vp8_dx();
+			auto&& iface = vpx_codec_vp9_dx();
+			auto threads = mv.decodeThreads ? mv.decodeThreads : std::min(4u, std::max(1u, std::thread::hardware_concurrency()));
+			vpx_codec_dec_cfg_t cfg{ threads, mv.width, mv.height };
+			if (int r = vpx_codec_dec_init(&ctx, iface, &cfg, 0)) return __LINE__;	// VPX_CODEC_OK == 0
+			if (mv.hasAlpha) {
+				if (int r = vpx_codec_dec_init(&ctxAlpha, iface, &cfg, 0)) {
+					vpx_codec_destroy(&ctx);
+					return __LINE__;
+				}
+				if (mv.decodeAlphaParallel && !worker.joinable()) {
+					worker = std::thread([this] { WorkerLoop(); });
+				}
+			}
+			inited = true;
+			return 0;
+		}
+
+		int DecodeAlpha() {
+			if (int r = vpx_codec_decode(&ctxAlpha, aBuf, aBufLen, nullptr, 0)) return __LINE__;
+			vpx_codec_iter_t iterator = nullptr;
+			imgA = vpx_codec_get_frame(&ctxAlpha, &iterator);
+			if (!imgA || imgA->fmt != VPX_IMG_FMT_I420) return __LINE__;
+			return 0;
+		}
 
-			for (uint32_t i = 0; i < this->count; ++i) {
-				if (int r = this->GetFrameBuf(i, rgbBuf, rgbBufLen, aBuf, aBufLen)) return r;
+		void WorkerLoop() {
+			std::unique_lock<std::mutex> g(mtx);
+			while (true) {
+				cv.wait(g, [this] { return state != 0 && state != 2; });
+				if (state < 0) return;
+				g.unlock();
+				auto r = DecodeAlpha();
+				g.lock();
+				aResult = r;
+				state = 2;
+				cv.notify_all();
+			}
+		}
 
-				if (int r = vpx_codec_decode(&ctx, rgbBuf, rgbBufLen, nullptr, 0)) return __LINE__;
-				if (int r = vpx_codec_decode(&ctxAlpha, aBuf, aBufLen, nullptr, 0)) return __LINE__;
+		// decode frame idx. success: fill imgRGB, imgA( nullptr when !hasAlpha )
+		int Decode(uint32_t const& idx) {
+			if (!inited) {
+				if (int r = Reset()) return r;
+			}
+			uint8_t const* rgbBuf = nullptr;
+			uint32_t rgbBufLen = 0;
+			imgRGB = imgA = nullptr;
+			if (mv.hasAlpha) {
+				if (int r = mv.GetFrameBuf(idx, rgbBuf, rgbBufLen, aBuf, aBufLen)) return r;
+				if (worker.joinable()) {
+					{
+						std::scoped_lock<std::mutex> g(mtx);
+						state = 1;
+					}
+					cv.notify_all();
+				}
+			} else {
+				if (int r = mv.GetFrameBuf(idx, rgbBuf, rgbBufLen)) return r;
+			}
 
+			int rgbResult = 0;
+			if (vpx_codec_decode(&ctx, rgbBuf, rgbBufLen, nullptr, 0)) {
+				rgbResult = __LINE__;
+			} else {
 				vpx_codec_iter_t iterator = nullptr;
-				auto&& imgRGB = vpx_codec_get_frame(&ctx, &iterator);
-				if (!imgRGB || imgRGB->fmt != VPX_IMG_FMT_I420) return __LINE__;
-				if (imgRGB->stride[1] != imgRGB->stride[2]) return __LINE__;
+				imgRGB = vpx_codec_get_frame(&ctx, &iterator);
+				if (!imgRGB || imgRGB->fmt != VPX_IMG_FMT_I420) rgbResult = __LINE__;
+				else if (imgRGB->stride[1] != imgRGB->stride[2]) rgbResult = __LINE__;
+			}
 
-				iterator = nullptr;
-				auto&& imgA = vpx_codec_get_frame(&ctxAlpha, &iterator);
-				if (!imgA || imgA->fmt != VPX_IMG_FMT_I420) return __LINE__;
+			if (mv.hasAlpha) {
+				if (worker.joinable()) {
+					std::unique_lock<std::mutex> g(mtx);
+					cv.wait(g, [this] { return state == 2; });
+					state = 0;
+				} else {
+					aResult = DecodeAlpha();
+				}
+				if (rgbResult) return rgbResult;
+				if (aResult) return aResult;
 				if (imgA->stride[0] != imgRGB->stride[0]) return __LINE__;
+			}
+			return rgbResult;
+		}
+	};
+
+	int Mv::ForeachFrame(YuvaHandler const& h, uint32_t const& beginIndex, uint32_t const& endIndex) const {
+		auto e = std::min(endIndex, this->count);
+		if (beginIndex >= e) return 0;
+		MvDecoder dec(*this);
+		if (int r = dec.Reset()) return r;
+		for (auto i = FindKeyFrame(beginIndex); i < e; ++i) {
+			if (int r = dec.Decode(i)) return r;
+			if (i < beginIndex) continue;
+			auto&& img = dec.imgRGB;
+			if (int r = h(i, this->width, this->height, img->planes[0], img->planes[1], img->planes[2], dec.imgA ? dec.imgA->planes[0] : nullptr, img->stride[0], img->stride[1])) return r;
+		}
+		return 0;
+	}
 
-				if (int r = h(i, this->width, this->height, imgRGB->planes[0], imgRGB->planes[1], imgRGB->planes[2], imgA->planes[0], imgRGB->stride[0], imgRGB->stride[1])) return r;
+	int Mv::DecodeFrame(uint32_t const& frameIndex, YuvaHandler const& h) const {
+		if (frameIndex >= count) return __LINE__;
+		return ForeachFrame(h, frameIndex, frameIndex + 1);
+	}
+
+	bool Mv::IsKeyFrame(uint32_t const& frameIndex) const {
+		if (frameIndex >= count) return false;
+		auto idx = hasAlpha ? frameIndex * 2 : frameIndex;
+		for (auto e = idx + hasAlpha; idx <= e; ++idx) {	// alpha stream is encoded apart: its key frames may not line up with rgb's
+			vpx_codec_stream_info_t si{};
+			si.sz = sizeof(si);
+			if (vpx_codec_peek_stream_info(vpx_codec_vp9_dx(), bufs[idx], lens[idx], &si)) return false;
+			if (!si.is_kf) return false;
+		}
+		return true;
+	}
+
+	uint32_t Mv::FindKeyFrame(uint32_t const& frameIndex) const {
+		auto iter = std::upper_bound(keyFrames.begin(), keyFrames.end(), frameIndex);
+		if (iter == keyFrames.begin()) return 0;
+		return *(iter - 1);
+	}
+
+	MvPlayer::~MvPlayer() {
+		Clear();
+	}
+
+	int MvPlayer::Init(Mv const& mv_, float const& fps_, size_t const& ringSize) {
+		Clear();
+		if (!mv_ || !mv_.codecId) return __LINE__;
+		mv = &mv_;
+		fps = fps_;
+		ring.resize(ringSize < 2 ? 2 : ringSize);
+		auto yaSiz = (size_t)mv->width * mv->height;
+		auto uvSiz = (size_t)((mv->width + 1) / 2) * ((mv->height + 1) / 2);
+		for (auto& f : ring) {
+			// reserve by frame size. real stride maybe bigger ( aligned ), will grow once at first decode
+			f.y.reserve(yaSiz);
+			f.u.reserve(uvSiz);
+			f.v.reserve(uvSiz);
+			if (mv->hasAlpha) {
+				f.a.reserve(yaSiz);
 			}
-		} else {
-			for (uint32_t i = 0; i < this->count; ++i) {
-				if (int r = this->GetFrameBuf(i, rgbBuf, rgbBufLen)) return r;
+		}
+		thread = std::thread([this] { DecodeLoop(); });
+		return 0;
+	}
 
-				if (int r = vpx_codec_decode(&ctx, rgbBuf, rgbBufLen, nullptr, 0)) return __LINE__;
+	void MvPlayer::Clear() {
+		if (thread.joinable()) {
+			{
+				std::scoped_lock<std::mutex> g(mtx);
+				stop = true;
+			}
+			cv.notify_one();
+			thread.join();
+		}
+		mv = {};
+		playing = false;
+		decodeSecs = 0;
+		error = 0;
+		ring.clear();
+		ringHead = ringCount = 0;
+		seekTo = serial = seekTarget = 0;
+		seekRequested = ended = stop = false;
+		time = 0;
+		curIndex = -1;
+		curYaStride = 0;
+		texY = {};
+		texU = {};
+		texV = {};
+		texA = {};
+	}
 
-				vpx_codec_iter_t iterator = nullptr;
-				auto&& imgRGB = vpx_codec_get_frame(&ctx, &iterator);
-				if (!imgRGB || imgRGB->fmt != VPX_IMG_FMT_I420) return __LINE__;
-				if (imgRGB->stride[1] != imgRGB->stride[2]) return __LINE__;
+	void MvPlayer::Play() {
+		playing = true;
+	}
 
-				if (int r = h(i, this->width, this->height, imgRGB->planes[0], imgRGB->planes[1], imgRGB->planes[2], nullptr, imgRGB->stride[0], imgRGB->stride[1])) return r;
+	void MvPlayer::Pause() {
+		playing = false;
+	}
+
+	void MvPlayer::Seek(uint32_t const& frameIndex) {
+		if (!mv) return;
+		auto target = std::min(frameIndex, mv->count - 1);
+		{
+			std::scoped_lock<std::mutex> g(mtx);
+			seekTo = mv->FindKeyFrame(target);
+			seekTarget = target;
+			++serial;
+			seekRequested = true;
+			ended = false;
+			ringCount = 0;
+		}
+		cv.notify_one();
+		time = target / fps;
+		curIndex = -1;
+	}
+
+	bool MvPlayer::Update(float const& delta) {
+		if (!mv || error) return false;
+		auto n = (int64_t)mv->count;
+		if (playing) {
+			time += delta * rate;
+		}
+		auto t = (int64_t)(time * fps);
+		if (t >= n) {
+			if (loop) {
+				time = std::fmod(time, n / (double)fps);
+				t = (int64_t)(time * fps) % n;
+			} else {
+				t = n - 1;
+				playing = false;
 			}
 		}
+		if (t == curIndex) return false;
 
-		return 0;
+		// count ring head's frames which are due ( cyclic distance to t in [0, n/2] ). show the last one, drop others
+		size_t k = 0;
+		{
+			std::scoped_lock<std::mutex> g(mtx);
+			for (; k < ringCount; ++k) {
+				auto d = (t - (int64_t)ring[(ringHead + k) % ring.size()].index + n) % n;
+				if (d > n / 2) break;	// ahead of t
+			}
+			if (!k) return false;	// decode thread fall behind: keep showing current frame
+			ringHead = (ringHead + k - 1) % ring.size();
+			ringCount -= k - 1;
+		}
+		// decode thread never touch ring[ringHead] while ringCount > 0
+		auto& f = ring[ringHead];
+		Upload(f);
+		curIndex = f.index;
+		{
+			std::scoped_lock<std::mutex> g(mtx);
+			ringHead = (ringHead + 1) % ring.size();
+			--ringCount;
+		}
+		cv.notify_one();
+		return true;
+	}
+
+	void MvPlayer::Upload(Frame const& f) {
+		auto uvh = (GLsizei)((mv->height + 1) / 2);
+		Shader_Yuva2Rgba::Upload(texY, 0, f.yaStride, mv->height, f.y.data());
+		Shader_Yuva2Rgba::Upload(texU, 1, f.uvStride, uvh, f.u.data());
+		Shader_Yuva2Rgba::Upload(texV, 2, f.uvStride, uvh, f.v.data());
+		Shader_Yuva2Rgba::Upload(texA, 3, f.yaStride, mv->height, f.a.empty() ? nullptr : f.a.data());
+		curYaStride = f.yaStride;
+	}
+
+	void MvPlayer::Draw(XY const& pos) {
+		if (!curYaStride) return;	// nothing uploaded yet. after seek: keep showing last frame until target ready
+		auto&& shader = engine.sm.GetShader<Shader_Yuva2Rgba>();
+		shader.Draw(texY, texU, texV, texA, curYaStride, mv->width, mv->height, pos);
+	}
+
+	int64_t MvPlayer::GetCurrentFrameIndex() const {
+		return curIndex;
+	}
+
+	size_t MvPlayer::GetMemorySize() {
+		std::scoped_lock<std::mutex> g(mtx);
+		size_t r = ring.capacity() * sizeof(Frame);
+		for (auto& f : ring) {
+			r += f.y.capacity() + f.u.capacity() + f.v.capacity() + f.a.capacity();
+		}
+		return r;
+	}
+
+	size_t MvPlayer::GetReadyCount(int64_t* headIndex) {
+		std::scoped_lock<std::mutex> g(mtx);
+		if (headIndex) {
+			*headIndex = ringCount ? (int64_t)ring[ringHead].index : -1;
+		}
+		return ringCount;
+	}
+
+	void MvPlayer::DecodeLoop() {
+		MvDecoder dec(*mv);
+		auto CopyPlane = [](std::vector<uint8_t>& dst, uint8_t const* src, size_t const& siz) {
+			dst.resize(siz);
+			memcpy(dst.data(), src, siz);
+		};
+		auto yaH = (size_t)mv->height, uvH = (size_t)((mv->height + 1) / 2);
+
+		uint32_t next = 0, ser = 0, skip = 0;
+		while (true) {
+			size_t slot;
+			{
+				std::unique_lock<std::mutex> g(mtx);
+				cv.wait(g, [&] { return stop || seekRequested || (!ended && ringCount < ring.size()); });
+				if (stop) return;
+				if (seekRequested) {
+					seekRequested = false;
+					next = seekTo;
+					skip = seekTarget;
+					ser = serial;
+					dec.Destroy();	// restart at key frame
+				}
+				slot = (ringHead + ringCount) % ring.size();
+			}
+
+			auto secs = NowEpochSeconds();
+			if (int r = dec.Decode(next)) {
+				error = r;
+				return;
+			}
+			if (next < skip) {	// decode from key frame to seek target
+				++next;
+				continue;
+			}
+			skip = 0;
+			auto& f = ring[slot];
+			auto&& img = dec.imgRGB;
+			if (dec.imgA) {
+				CopyPlane(f.a, dec.imgA->planes[0], dec.imgA->stride[0] * yaH);
+			}
+			CopyPlane(f.y, img->planes[0], img->stride[0] * yaH);
+			CopyPlane(f.u, img->planes[1], img->stride[1] * uvH);
+			CopyPlane(f.v, img->planes[2], img->stride[2] * uvH);
+			f.yaStride = img->stride[0];
+			f.uvStride = img->stride[1];
+			f.index = next;
+			decodeSecs = (float)NowEpochSeconds(secs);
+
+			{
+				std::scoped_lock<std::mutex> g(mtx);
+				if (ser != serial) continue;	// seek happened while decoding: discard
+				++ringCount;
+				if (++next == mv->count) {
+					if (loop) {
+						next = 0;	// frame 0 is key frame: continue decode without reset
+					} else {
+						ended = true;
+					}
+				}
+			}
+		}
 	}
 
 }
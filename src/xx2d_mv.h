@@ -4,20 +4,40 @@
 namespace xx {
 
 	struct Mv {
+		// file header: "xxmv" + version( uint8 ). written by WriteTo ( tools_mv_bake -reheader converts old files )
+		// version 2: key frame table ( count + indexs ) follows lens. Load & LoadView read it, never peek frame data
+		// version 1 & headerless legacy files: keyFrames are scanned at load ( IsKeyFrame peeks every frame, touching all payload pages )
+		inline static constexpr std::array<char, 4> magic{ 'x', 'x', 'm', 'v' };
+		inline static constexpr uint8_t version = 2;
+
 		uint8_t codecId = 0;	// 0: vp8   1: vp9 ( current support vp9 only )
 		uint8_t hasAlpha = 0;
 		uint16_t width = 0;
 		uint16_t height = 0;
 		float duration = 0;	// issue
 		std::vector<uint32_t> lens;	// all frame data's len here. hasAlpha == 0: [rgb], ...   == 1: [rgb + a], ...
-		xx::Data data;	// all frame data here
+		xx::Data data;	// owned memory. Load( Data_r ): frame data copy. Load( Data&& ): whole file. LoadView: empty
 
 		std::vector<uint8_t*> bufs;	// fill by Load
 		uint32_t count = 0;	// fill by Load
+		std::vector<uint32_t> keyFrames;	// fill by Load ( version 2: from header, else scan ). IsKeyFrame indexs ( asc, [0] == 0 ). safe restart points for ForeachFrame / Seek
+
+		// decode options. benchmark: bench/mv_decode.cpp
+		uint32_t decodeThreads = 0;			// vpx_codec_dec_cfg_t::threads. 0: hardware_concurrency ( max 4 ). only help when frame has several tile columns
+		bool decodeAlphaParallel = true;	// hasAlpha: decode alpha stream on a worker thread, join per frame. up to 2x when decode dominates
 
-		// load data from .xxmv. return 0 mean success
+		// load data from .xxmv. copy frame data into data. return 0 mean success
 		int Load(xx::Data_r d);
 
+		// zero copy: take ownership of file data. bufs point into it. benchmark: bench/mv_load.cpp
+		int Load(xx::Data&& d);
+
+		// zero copy: borrow d ( mmap'd file, pack entry ... ). only validate frame table. d's memory must be alive before Clear / reload
+		int LoadView(xx::Data_r const& d);
+
+		// write header ( current version ) + fields + frame table + keyFrames + frame data ( from bufs, so a LoadView'd mv can be written too )
+		void WriteTo(xx::Data& d) const;
+
 		operator bool() const;
 
 		void Clear();
@@ -26,11 +46,111 @@ namespace xx {
 			, uint8_t const* const& yData, uint8_t const* const& uData, uint8_t const* const& vData, uint8_t const* const& aData
 			, uint32_t const& yaStride, uint32_t const& uvStride)>;
 
-		// decode & handle every frmae's yuva data
-		int ForeachFrame(YuvaHandler const& h) const;
+		// decode & handle frames [beginIndex, endIndex) yuva data. decode start at nearest key frame <= beginIndex
+		// ( frames before beginIndex are decoded but not handled ). segments can be decoded by different threads ( split by keyFrames. see bench/mv_decode.cpp )
+		int ForeachFrame(YuvaHandler const& h, uint32_t const& beginIndex = 0, uint32_t const& endIndex = std::numeric_limits<uint32_t>::max()) const;
+
+		// decode & handle one frame ( random access )
+		int DecodeFrame(uint32_t const& frameIndex, YuvaHandler const& h) const;
+
+		// peek frame data's header. alpha video: true only when both rgb & alpha frame are key frames ( streams are encoded apart )
+		bool IsKeyFrame(uint32_t const& frameIndex) const;
+
+		// return nearest key frame index <= frameIndex ( binary search keyFrames )
+		uint32_t FindKeyFrame(uint32_t const& frameIndex) const;
 
 	protected:
+		friend struct MvPlayer;
+		friend struct MvDecoder;
+		int LoadCore(xx::Data_r d, bool const& copy);
 		int GetFrameBuf(uint32_t const& idx, uint8_t const*& rgbBuf, uint32_t& rgbBufLen) const;
 		int GetFrameBuf(uint32_t idx, uint8_t const*& rgbBuf, uint32_t& rgbBufLen, uint8_t const*& aBuf, uint32_t& aBufLen) const;
 	};
+
+	// I420 + alpha to RGBA8 ( same formula as Shader_Yuva2Rgba, max diff 1 ). aData == nullptr: alpha = 255
+	// dst: dstStride * h bytes. dstStride == 0: w * 4. premultiply: rgb *= a / 255. simd: AVX2 when cmake XX2D_ENABLE_AVX2 ( needs an AVX2 cpu ), else SSE2
+	void YuvaToRgba(uint8_t* dst, uint32_t dstStride, uint32_t const& w, uint32_t const& h
+		, uint8_t const* const& yData, uint8_t const* const& uData, uint8_t const* const& vData, uint8_t const* const& aData
+		, uint32_t const& yaStride, uint32_t const& uvStride, bool const& premultiply = false);
+
+	// same result as YuvaToRgba, no simd. for verify
+	void YuvaToRgba_Scalar(uint8_t* dst, uint32_t dstStride, uint32_t const& w, uint32_t const& h
+		, uint8_t const* const& yData, uint8_t const* const& uData, uint8_t const* const& vData, uint8_t const* const& aData
+		, uint32_t const& yaStride, uint32_t const& uvStride, bool const& premultiply = false);
+
+	using RgbaHandler = std::function<int(int const& frameIndex, uint32_t const& w, uint32_t const& h, uint8_t const* const& rgba)>;
+
+	// wrap h for Mv::ForeachFrame: convert every frame to rgba ( tight, w * 4 stride, reused buffer ) then call h
+	Mv::YuvaHandler MakeRgbaHandler(RgbaHandler h, bool const& premultiply = false);
+
+	// streaming playback: background thread decode ahead into a small ring of yuva frames,
+	// main thread upload current frame to reused textures only when it changes
+	// Init return immediately. first frame latency = 1 decode ( decodeSecs ). seek latency = decode from nearest key frame
+	// cpu: ringSize * W * H * 1.5 ( + W * H with alpha ) bytes ( by stride ). gpu: 1 frame's planes. measured: bench/mv_player.cpp
+	struct MvPlayer {
+		struct Frame {
+			uint32_t index = 0;
+			uint32_t yaStride = 0, uvStride = 0;
+			std::vector<uint8_t> y, u, v, a;	// a: empty when !mv->hasAlpha
+		};
+
+		Mv const* mv{};
+		float fps = 60;
+		float rate = 1;			// playback speed
+		std::atomic<bool> loop{ true };	// read by decode thread at clip end
+		bool playing = false;
+
+		// stats ( write by decode thread )
+		std::atomic<float> decodeSecs{};	// last frame's decode + copy elapsed secs
+		std::atomic<int> error{};			// != 0: decode thread stopped. value is __LINE__
+
+		MvPlayer() = default;
+		MvPlayer(MvPlayer const&) = delete;
+		MvPlayer& operator=(MvPlayer const&) = delete;
+		~MvPlayer();
+
+		// mv must be alive before Clear. ringSize: decode ahead frame count. return 0 mean success
+		int Init(Mv const& mv_, float const& fps_ = 60, size_t const& ringSize = 4);
+
+		// stop decode thread & release ring, textures
+		void Clear();
+
+		void Play();
+		void Pause();
+
+		// jump to frameIndex. decode thread start at nearest key frame and drop frames before frameIndex
+		void Seek(uint32_t const& frameIndex);
+
+		// advance time by delta * rate, upload due frame. return true if current frame changed
+		bool Update(float const& delta);
+
+		void Draw(XY const& pos = {});
+
+		// < 0: nothing uploaded yet
+		int64_t GetCurrentFrameIndex() const;
+
+		// ring frames bytes ( decode ahead memory. not include gpu textures )
+		size_t GetMemorySize();
+
+		// decoded frames waiting in ring. headIndex: next frame Update will show ( -1: none ). no gl: bench/mv_player.cpp polls it
+		size_t GetReadyCount(int64_t* headIndex = nullptr);
+
+	protected:
+		std::vector<Frame> ring;
+		size_t ringHead = 0, ringCount = 0;	// guard by mtx
+		uint32_t seekTo = 0, serial = 0;	// guard by mtx. serial: bump when seek, decoding frame will be discard if changed
+		uint32_t seekTarget = 0;	// guard by mtx. frames < seekTarget are decoded but not push to ring
+		bool seekRequested = false, ended = false, stop = false;	// guard by mtx
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::thread thread;
+
+		double time = 0;
+		int64_t curIndex = -1;
+		uint32_t curYaStride = 0;
+		GLTexture texY, texU, texV, texA;
+
+		void DecodeLoop();
+		void Upload(Frame const& f);
+	};
 }
@@ -0,0 +1,209 @@
+﻿#include "xx2d.h"
+// __AVX2__: cmake -DXX2D_ENABLE_AVX2=ON ( -mavx2 / /arch:AVX2 ). default build: SSE2 ( x64 baseline )
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define XX_YUVA_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XX_YUVA_SSE2
+#endif
+
+namespace xx {
+
+	// same formula as Shader_Yuva2Rgba ( full range bt.601 ). every path use the same fixed point math, results are identical:
+	// c = ( y * 4 + mulhi( ( uv - 128 ) << 7, k ) + 2 ) >> 2, k = coefficient * 2048. max diff to float formula is 1
+	static constexpr int16_t yuvaKRV = 2871, yuvaKGU = 705, yuvaKGV = 1462, yuvaKBU = 3629;	// 1.402, 0.344, 0.714, 1.772
+
+	inline static int32_t YuvaMulHi(int32_t const& a, int32_t const& k) {
+		return (a * k) >> 16;
+	}
+
+	inline static uint8_t YuvaClamp(int32_t const& c) {
+		return (uint8_t)(c < 0 ? 0 : (c > 255 ? 255 : c));
+	}
+
+	// c * a / 255 ( rounded )
+	inline static uint8_t YuvaPremultiply(uint32_t const& c, uint32_t const& a) {
+		auto t = c * a + 128;
+		return (uint8_t)((t + (t >> 8)) >> 8);
+	}
+
+	// convert pixels [x, w) of a row
+	static void YuvaToRgbaRow_Scalar(uint8_t* d, uint32_t x, uint32_t const& w, uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t const* a, bool const& premultiply) {
+		for (; x < w; ++x) {
+			int32_t yy = y[x] * 4;
+			int32_t uu = (u[x >> 1] - 128) * 128;
+			int32_t vv = (v[x >> 1] - 128) * 128;
+			auto r = YuvaClamp((yy + YuvaMulHi(vv, yuvaKRV) + 2) >> 2);
+			auto g = YuvaClamp((yy - YuvaMulHi(uu, yuvaKGU) - YuvaMulHi(vv, yuvaKGV) + 2) >> 2);
+			auto b = YuvaClamp((yy + YuvaMulHi(uu, yuvaKBU) + 2) >> 2);
+			uint8_t aa = a ? a[x] : 255;
+			if (premultiply) {
+				r = YuvaPremultiply(r, aa);
+				g = YuvaPremultiply(g, aa);
+				b = YuvaPremultiply(b, aa);
+			}
+			auto p = d + x * 4;
+			p[0] = r;
+			p[1] = g;
+			p[2] = b;
+			p[3] = aa;
+		}
+	}
+
+#if defined(XX_YUVA_AVX2)
+
+	// 16 pixels: yy = y * 4, uu vv = ( uv - 128 ) << 7 ( already duplicated per pixel ). return rg | ba << 16 per pixel as 2 x u16 vectors
+	inline static void YuvaCalc16(__m256i const& yy, __m256i const& uu, __m256i const& vv, __m256i const& aa, bool const& premultiply, __m256i& rg, __m256i& ba) {
+		auto zero = _mm256_setzero_si256();
+		auto c255 = _mm256_set1_epi16(255);
+		auto c2 = _mm256_set1_epi16(2);
+		auto r = _mm256_add_epi16(_mm256_add_epi16(yy, c2), _mm256_mulhi_epi16(vv, _mm256_set1_epi16(yuvaKRV)));
+		auto g = _mm256_sub_epi16(_mm256_sub_epi16(_mm256_add_epi16(yy, c2), _mm256_mulhi_epi16(uu, _mm256_set1_epi16(yuvaKGU))), _mm256_mulhi_epi16(vv, _mm256_set1_epi16(yuvaKGV)));
+		auto b = _mm256_add_epi16(_mm256_add_epi16(yy, c2), _mm256_mulhi_epi16(uu, _mm256_set1_epi16(yuvaKBU)));
+		r = _mm256_min_epi16(_mm256_max_epi16(_mm256_srai_epi16(r, 2), zero), c255);
+		g = _mm256_min_epi16(_mm256_max_epi16(_mm256_srai_epi16(g, 2), zero), c255);
+		b = _mm256_min_epi16(_mm256_max_epi16(_mm256_srai_epi16(b, 2), zero), c255);
+		if (premultiply) {
+			auto c128 = _mm256_set1_epi16(128);
+			auto pm = [&](__m256i c) {
+				auto t = _mm256_add_epi16(_mm256_mullo_epi16(c, aa), c128);
+				return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+			};
+			r = pm(r);
+			g = pm(g);
+			b = pm(b);
+		}
+		rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+		ba = _mm256_or_si256(b, _mm256_slli_epi16(aa, 8));
+	}
+
+	// duplicate 8 chroma bytes to 16 pixels, to ( uv - 128 ) << 7
+	inline static __m256i YuvaLoadUV(uint8_t const* p) {
+		auto c = _mm_loadl_epi64((__m128i const*)p);
+		auto w = _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(c, c));
+		return _mm256_slli_epi16(_mm256_sub_epi16(w, _mm256_set1_epi16(128)), 7);
+	}
+
+	inline static void YuvaStore16(uint8_t* d, __m256i const& rg, __m256i const& ba) {
+		auto lo = _mm256_unpacklo_epi16(rg, ba);	// pixels 0 ~ 3, 8 ~ 11
+		auto hi = _mm256_unpackhi_epi16(rg, ba);	// pixels 4 ~ 7, 12 ~ 15
+		_mm256_storeu_si256((__m256i*)d, _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i*)(d + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+
+	static void YuvaToRgbaRow(uint8_t* d, uint32_t const& w, uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t const* a, bool const& premultiply) {
+		uint32_t x = 0;
+		auto c255 = _mm256_set1_epi16(255);
+		for (; x + 16 <= w; x += 16) {
+			auto yy = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const*)(y + x))), 2);
+			auto aa = a ? _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const*)(a + x))) : c255;
+			__m256i rg, ba;
+			YuvaCalc16(yy, YuvaLoadUV(u + x / 2), YuvaLoadUV(v + x / 2), aa, premultiply, rg, ba);
+			YuvaStore16(d + x * 4, rg, ba);
+		}
+		YuvaToRgbaRow_Scalar(d, x, w, y, u, v, a, premultiply);
+	}
+
+#elif defined(XX_YUVA_SSE2)
+
+	// 8 pixels. same as avx2 version
+	inline static void YuvaCalc8(__m128i const& yy, __m128i const& uu, __m128i const& vv, __m128i const& aa, bool const& premultiply, __m128i& rg, __m128i& ba) {
+		auto zero = _mm_setzero_si128();
+		auto c255 = _mm_set1_epi16(255);
+		auto c2 = _mm_set1_epi16(2);
+		auto r = _mm_add_epi16(_mm_add_epi16(yy, c2), _mm_mulhi_epi16(vv, _mm_set1_epi16(yuvaKRV)));
+		auto g = _mm_sub_epi16(_mm_sub_epi16(_mm_add_epi16(yy, c2), _mm_mulhi_epi16(uu, _mm_set1_epi16(yuvaKGU))), _mm_mulhi_epi16(vv, _mm_set1_epi16(yuvaKGV)));
+		auto b = _mm_add_epi16(_mm_add_epi16(yy, c2), _mm_mulhi_epi16(uu, _mm_set1_epi16(yuvaKBU)));
+		r = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(r, 2), zero), c255);
+		g = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(g, 2), zero), c255);
+		b = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(b, 2), zero), c255);
+		if (premultiply) {
+			auto c128 = _mm_set1_epi16(128);
+			auto pm = [&](__m128i c) {
+				auto t = _mm_add_epi16(_mm_mullo_epi16(c, aa), c128);
+				return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+			};
+			r = pm(r);
+			g = pm(g);
+			b = pm(b);
+		}
+		rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+		ba = _mm_or_si128(b, _mm_slli_epi16(aa, 8));
+	}
+
+	inline static void YuvaStore8(uint8_t* d, __m128i const& rg, __m128i const& ba) {
+		_mm_storeu_si128((__m128i*)d, _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128((__m128i*)(d + 16), _mm_unpackhi_epi16(rg, ba));
+	}
+
+	static void YuvaToRgbaRow(uint8_t* d, uint32_t const& w, uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t const* a, bool const& premultiply) {
+		uint32_t x = 0;
+		auto zero = _mm_setzero_si128();
+		auto c128 = _mm_set1_epi16(128);
+		auto c255 = _mm_set1_epi16(255);
+		for (; x + 16 <= w; x += 16) {
+			auto y8 = _mm_loadu_si128((__m128i const*)(y + x));
+			auto u8 = _mm_loadl_epi64((__m128i const*)(u + x / 2));
+			auto v8 = _mm_loadl_epi64((__m128i const*)(v + x / 2));
+			auto u16 = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(u8, zero), c128), 7);
+			auto v16 = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(v8, zero), c128), 7);
+			__m128i a0 = c255, a1 = c255;
+			if (a) {
+				auto a8 = _mm_loadu_si128((__m128i const*)(a + x));
+				a0 = _mm_unpacklo_epi8(a8, zero);
+				a1 = _mm_unpackhi_epi8(a8, zero);
+			}
+			__m128i rg, ba;
+			YuvaCalc8(_mm_slli_epi16(_mm_unpacklo_epi8(y8, zero), 2), _mm_unpacklo_epi16(u16, u16), _mm_unpacklo_epi16(v16, v16), a0, premultiply, rg, ba);
+			YuvaStore8(d + x * 4, rg, ba);
+			YuvaCalc8(_mm_slli_epi16(_mm_unpackhi_epi8(y8, zero), 2), _mm_unpackhi_epi16(u16, u16), _mm_unpackhi_epi16(v16, v16), a1, premultiply, rg, ba);
+			YuvaStore8(d + x * 4 + 32, rg, ba);
+		}
+		YuvaToRgbaRow_Scalar(d, x, w, y, u, v, a, premultiply);
+	}
+
+#else
+
+	static void YuvaToRgbaRow(uint8_t* d, uint32_t const& w, uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t const* a, bool const& premultiply) {
+		YuvaToRgbaRow_Scalar(d, 0, w, y, u, v, a, premultiply);
+	}
+
+#endif
+
+	void YuvaToRgba(uint8_t* dst, uint32_t dstStride, uint32_t const& w, uint32_t const& h
+		, uint8_t const* const& yData, uint8_t const* const& uData, uint8_t const* const& vData, uint8_t const* const& aData
+		, uint32_t const& yaStride, uint32_t const& uvStride, bool const& premultiply) {
+		if (!dstStride) {
+			dstStride = w * 4;
+		}
+		for (uint32_t j = 0; j < h; ++j) {
+			YuvaToRgbaRow(dst + (size_t)dstStride * j, w, yData + (size_t)yaStride * j, uData + (size_t)uvStride * (j / 2), vData + (size_t)uvStride * (j / 2)
+				, aData ? aData + (size_t)yaStride * j : nullptr, premultiply);
+		}
+	}
+
+	void YuvaToRgba_Scalar(uint8_t* dst, uint32_t dstStride, uint32_t const& w, uint32_t const& h
+		, uint8_t const* const& yData, uint8_t const* const& uData, uint8_t const* const& vData, uint8_t const* const& aData
+		, uint32_t const& yaStride, uint32_t const& uvStride, bool const& premultiply) {
+		if (!dstStride) {
+			dstStride = w * 4;
+		}
+		for (uint32_t j = 0; j < h; ++j) {
+			YuvaToRgbaRow_Scalar(dst + (size_t)dstStride * j, 0, w, yData + (size_t)yaStride * j, uData + (size_t)uvStride * (j / 2), vData + (size_t)uvStride * (j / 2)
+				, aData ? aData + (size_t)yaStride * j : nullptr, premultiply);
+		}
+	}
+
+	Mv::YuvaHandler MakeRgbaHandler(RgbaHandler h, bool const& premultiply) {
+		return [h = std::move(h), premultiply, buf = std::vector<uint8_t>()](int const& frameIndex, uint32_t const& w, uint32_t const& h_
+			, uint8_t const* const& yData, uint8_t const* const& uData, uint8_t const* const& vData, uint8_t const* const& aData
+			, uint32_t const& yaStride, uint32_t const& uvStride) mutable->int {
+			buf.resize((size_t)w * h_ * 4);
+			YuvaToRgba(buf.data(), 0, w, h_, yData, uData, vData, aData, yaStride, uvStride, premultiply);
+			return h(frameIndex, w, h_, buf.data());
+		};
+	}
+}
+
+// verify ( simd == scalar, max diff 1 to float formula ) & bench: bench/yuva_to_rgba.cpp
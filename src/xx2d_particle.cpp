@@ -1,10 +1,259 @@
 ﻿#include "xx2d.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define XX_PARTICLE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XX_PARTICLE_SSE2
+#endif
 
 namespace xx {
 
-    void Particle::Init(xx::Shared<ParticleConfig> cfg_, size_t const& cap, std::pair<uint32_t, uint32_t> blendFuncs_) {
-        particles.Clear<true>();
-        particles.Reserve(cap);
+    void ParticlePool::Init(size_t const& budget_, size_t numBlocks_) {
+        budget = budget_;
+        if (!numBlocks_) {
+            numBlocks_ = (budget + blockSize - 1) / blockSize;
+            numBlocks_ += std::max<size_t>(64, numBlocks_ / 4);   // for emitters' partial blocks
+        }
+        numBlocks = numBlocks_;
+        peakUsedBlocks = 0;
+        buf = std::make_unique<float[]>(numBlocks * numFields * blockSize);
+        freeBlocks.resize(numBlocks);
+        for (size_t i = 0; i < numBlocks; ++i) {
+            freeBlocks[i] = buf.get() + (numBlocks - 1 - i) * numFields * blockSize;   // pop from low address
+        }
+    }
+
+    float* ParticlePool::Alloc() {
+        std::lock_guard<std::mutex> lg(mtx);
+        if (freeBlocks.empty()) return nullptr;
+        auto b = freeBlocks.back();
+        freeBlocks.pop_back();
+        peakUsedBlocks = std::max(peakUsedBlocks, numBlocks - freeBlocks.size());
+        return b;
+    }
+
+    void ParticlePool::Free(float* const& b) {
+        std::lock_guard<std::mutex> lg(mtx);
+        freeBlocks.push_back(b);
+    }
+
+    size_t ParticlePool::GetUsedBlocks() {
+        std::lock_guard<std::mutex> lg(mtx);
+        return numBlocks - freeBlocks.size();
+    }
+
+    ParticleItems::~ParticleItems() {
+        Clear();
+    }
+
+    void ParticleItems::Init(xx::Shared<ParticlePool> pool_, size_t const& cap_) {
+        Clear();
+        cap = cap_;
+        if (pool_) {
+            pool = std::move(pool_);
+        } else {
+            pool = xx::Make<ParticlePool>();
+            pool->Init(cap, (cap + bs - 1) / bs);
+        }
+    }
+
+    void ParticleItems::Clear() {
+        for (auto&& b : blocks) {
+            pool->Free(b);
+        }
+        blocks.clear();
+        len = 0;
+    }
+
+    bool ParticleItems::Add(ParticleItem const& o) {
+        assert(len < cap);
+        if (len == blocks.size() * bs) {
+            auto b = pool->Alloc();
+            if (!b) return false;
+            blocks.push_back(b);
+        }
+        auto p = blocks.back() + len % bs;
+        ++len;
+        float const vs[ParticlePool::numFields] = { o.pos.x, o.pos.y, o.velocity.x, o.velocity.y, o.gravity, o.radialAccel, o.tangentialAccel
+            , o.spin, o.spinDelta, o.size, o.sizeDelta, o.age, o.terminalAge
+            , o.color.r, o.color.g, o.color.b, o.color.a, o.colorDelta.r, o.colorDelta.g, o.colorDelta.b, o.colorDelta.a };
+        for (size_t f = 0; f < ParticlePool::numFields; ++f) {
+            p[f * bs] = vs[f];
+        }
+        return true;
+    }
+
+    ParticleItem ParticleItems::operator[](size_t const& i) const {
+        assert(i < len);
+        auto p = blocks[i / bs] + i % bs;
+        auto F = [&](Fields const& f) { return p[f * bs]; };
+        return { { F(PosX), F(PosY) }, { F(VelocityX), F(VelocityY) }, F(Gravity), F(RadialAccel), F(TangentialAccel)
+            , F(Spin), F(SpinDelta), F(Size), F(SizeDelta), F(Age), F(TerminalAge)
+            , { F(ColorR), F(ColorG), F(ColorB), F(ColorA) }, { F(ColorDeltaR), F(ColorDeltaG), F(ColorDeltaB), F(ColorDeltaA) } };
+    }
+
+    void ParticleItems::Remove(size_t const& i) {
+        assert(i < len);
+        auto last = --len;
+        if (i != last) {
+            auto d = blocks[i / bs] + i % bs;
+            auto s = blocks[last / bs] + last % bs;
+            for (size_t f = 0; f < ParticlePool::numFields; ++f) {
+                d[f * bs] = s[f * bs];
+            }
+        }
+        if (len % bs == 0) {
+            pool->Free(blocks.back());
+            blocks.pop_back();
+        }
+    }
+
+    void ParticleItems::UpdateAge(float const& delta) {
+        for (size_t bi = 0, n = blocks.size(); bi < n; ++bi) {
+            auto age = Field(bi, Age);
+            auto e = std::min(bs, len - bi * bs);
+            size_t i = 0;
+#if defined(XX_PARTICLE_AVX2)
+            auto d8 = _mm256_set1_ps(delta);
+            for (; i + 8 <= e; i += 8) {
+                _mm256_storeu_ps(age + i, _mm256_add_ps(_mm256_loadu_ps(age + i), d8));
+            }
+#elif defined(XX_PARTICLE_SSE2)
+            auto d4 = _mm_set1_ps(delta);
+            for (; i + 4 <= e; i += 4) {
+                _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), d4));
+            }
+#endif
+            for (; i < e; ++i) {
+                age[i] += delta;
+            }
+        }
+        for (size_t i = 0; i < len;) {
+            auto age = blocks[i / bs] + Age * bs, terminalAge = blocks[i / bs] + TerminalAge * bs;
+            auto j = i % bs;
+#if defined(XX_PARTICLE_AVX2)
+            if (i + 8 <= len && j + 8 <= bs && !_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(age + j), _mm256_loadu_ps(terminalAge + j), _CMP_GE_OQ))) {
+                i += 8;     // all alive
+                continue;
+            }
+#elif defined(XX_PARTICLE_SSE2)
+            if (i + 4 <= len && j + 4 <= bs && !_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(age + j), _mm_loadu_ps(terminalAge + j)))) {
+                i += 4;     // all alive
+                continue;
+            }
+#endif
+            if (age[j] >= terminalAge[j]) {
+                Remove(i);  // the moved in item is aged too
+            } else {
+                ++i;
+            }
+        }
+    }
+
+#if defined(XX_PARTICLE_AVX2) || defined(XX_PARTICLE_SSE2)
+#if defined(XX_PARTICLE_AVX2)
+    struct ParticleSimd {
+        using V = __m256;
+        static constexpr size_t width = 8;
+        static V Load(float const* p) { return _mm256_loadu_ps(p); }
+        static void Store(float* p, V const& v) { _mm256_storeu_ps(p, v); }
+        static V Set1(float const& f) { return _mm256_set1_ps(f); }
+        static V Add(V const& a, V const& b) { return _mm256_add_ps(a, b); }
+        static V Sub(V const& a, V const& b) { return _mm256_sub_ps(a, b); }
+        static V Mul(V const& a, V const& b) { return _mm256_mul_ps(a, b); }
+        static V Div(V const& a, V const& b) { return _mm256_div_ps(a, b); }
+        static V Sqrt(V const& a) { return _mm256_sqrt_ps(a); }
+        static V Neg(V const& a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.f)); }
+    };
+#else
+    struct ParticleSimd {
+        using V = __m128;
+        static constexpr size_t width = 4;
+        static V Load(float const* p) { return _mm_loadu_ps(p); }
+        static void Store(float* p, V const& v) { _mm_storeu_ps(p, v); }
+        static V Set1(float const& f) { return _mm_set1_ps(f); }
+        static V Add(V const& a, V const& b) { return _mm_add_ps(a, b); }
+        static V Sub(V const& a, V const& b) { return _mm_sub_ps(a, b); }
+        static V Mul(V const& a, V const& b) { return _mm_mul_ps(a, b); }
+        static V Div(V const& a, V const& b) { return _mm_div_ps(a, b); }
+        static V Sqrt(V const& a) { return _mm_sqrt_ps(a); }
+        static V Neg(V const& a) { return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+    };
+#endif
+#endif
+
+    // integrate slots [begin, end) of a block
+    static void ParticleIntegrateBlock(float* const& blk, size_t begin, size_t const& end, XY const& center, float const& delta) {
+        using F = ParticleItems;
+        constexpr auto bs = F::bs;
+        auto posX = blk + F::PosX * bs, posY = blk + F::PosY * bs, velocityX = blk + F::VelocityX * bs, velocityY = blk + F::VelocityY * bs;
+        auto gravity = blk + F::Gravity * bs, radialAccel = blk + F::RadialAccel * bs, tangentialAccel = blk + F::TangentialAccel * bs;
+        auto spin = blk + F::Spin * bs, spinDelta = blk + F::SpinDelta * bs, size = blk + F::Size * bs, sizeDelta = blk + F::SizeDelta * bs;
+        auto r = blk + F::ColorR * bs, g = blk + F::ColorG * bs, b = blk + F::ColorB * bs, a = blk + F::ColorA * bs;
+        auto dr = blk + F::ColorDeltaR * bs, dg = blk + F::ColorDeltaG * bs, db = blk + F::ColorDeltaB * bs, da = blk + F::ColorDeltaA * bs;
+#if defined(XX_PARTICLE_AVX2) || defined(XX_PARTICLE_SSE2)
+        using S = ParticleSimd;
+        auto d = S::Set1(delta), cx = S::Set1(center.x), cy = S::Set1(center.y);
+        for (; begin + S::width <= end; begin += S::width) {
+            auto i = begin;
+            auto dx = S::Sub(S::Load(posX + i), cx);
+            auto dy = S::Sub(S::Load(posY + i), cy);
+            auto v = S::Sqrt(S::Add(S::Mul(dx, dx), S::Mul(dy, dy)));
+            auto nx = S::Div(dx, v), ny = S::Div(dy, v);
+            auto ra = S::Load(radialAccel + i), ta = S::Load(tangentialAccel + i);
+            auto vx = S::Add(S::Load(velocityX + i), S::Mul(S::Add(S::Mul(nx, ra), S::Mul(S::Neg(ny), ta)), d));
+            auto vy = S::Add(S::Load(velocityY + i), S::Mul(S::Add(S::Mul(ny, ra), S::Mul(nx, ta)), d));
+            vy = S::Add(vy, S::Mul(S::Load(gravity + i), d));
+            S::Store(velocityX + i, vx);
+            S::Store(velocityY + i, vy);
+            S::Store(posX + i, S::Add(S::Load(posX + i), S::Mul(vx, d)));
+            S::Store(posY + i, S::Add(S::Load(posY + i), S::Mul(vy, d)));
+            auto Step = [&](float* p, float const* pd) {
+                S::Store(p + i, S::Add(S::Load(p + i), S::Mul(S::Load(pd + i), d)));
+            };
+            Step(spin, spinDelta);
+            Step(size, sizeDelta);
+            Step(r, dr);
+            Step(g, dg);
+            Step(b, db);
+            Step(a, da);
+        }
+#endif
+        for (auto i = begin; i < end; ++i) {
+            XY vecAccel{ posX[i] - center.x, posY[i] - center.y };
+            vecAccel.Normalize();
+            XY vecAccel2{ -vecAccel.y, vecAccel.x };    // Rotate(M_PI_2)
+            vecAccel *= radialAccel[i];
+            vecAccel2 *= tangentialAccel[i];
+            auto acc = (vecAccel + vecAccel2) * delta;
+            velocityX[i] += acc.x;
+            velocityY[i] += acc.y;
+            velocityY[i] += gravity[i] * delta;
+            posX[i] += velocityX[i] * delta;
+            posY[i] += velocityY[i] * delta;
+            spin[i] += spinDelta[i] * delta;
+            size[i] += sizeDelta[i] * delta;
+            r[i] += dr[i] * delta;
+            g[i] += dg[i] * delta;
+            b[i] += db[i] * delta;
+            a[i] += da[i] * delta;
+        }
+    }
+
+    void ParticleItems::Integrate(XY const& center, float const& delta, size_t begin, size_t const& end) {
+        assert(end <= len);
+        while (begin < end) {
+            auto bi = begin / bs;
+            auto e = std::min(end, (bi + 1) * bs);
+            ParticleIntegrateBlock(blocks[bi], begin % bs, e - bi * bs, center, delta);
+            begin = e;
+        }
+    }
+
+    void Particle::Init(xx::Shared<ParticleConfig> cfg_, size_t const& cap, std::pair<uint32_t, uint32_t> blendFuncs_, uint64_t const& seed, xx::Shared<ParticlePool> pool) {
+        particles.Init(std::move(pool), cap);
+        rnd.SetSeed(seed ? seed : engine.rnd.Next<uint64_t>());
         blendFuncs = blendFuncs_;
         cfg = std::move(cfg_);
 
@@ -13,6 +262,18 @@ namespace xx {
 
         emissionResidue = {};
         age = -2.0;
+        spawnLimit = std::numeric_limits<size_t>::max();
+        deniedCount = 0;
+    }
+
+    size_t Particle::PeekSpawnCount(float const& delta) const {
+        auto a = age;
+        if (a >= 0) {
+            a += delta;
+            if (a >= cfg->lifetime) return 0;
+        }
+        if (a == -2.0f) return 0;
+        return (uint32_t)(cfg->emission * delta + emissionResidue);
     }
 
     void Particle::Update(const float delta) {
@@ -28,41 +289,8 @@ namespace xx {
 
         // update all alive particles
 
-        int prev = -1, next{};
-        for (auto idx = particles.head; idx != -1;) {
-            auto& p = particles[idx];
-
-            p.age += delta;
-            if (p.age >= p.terminalAge) {
-                next = particles.Remove(idx, prev);
-            } else {
-                next = particles.Next(idx);
-                prev = idx;
-                {
-                    XY vecAccel = p.pos - pos;
-                    vecAccel.Normalize();
-                    XY vecAccel2 = vecAccel;
-                    vecAccel *= p.radialAccel;
-
-                    // vecAccel2.Rotate(M_PI_2);
-                    // the following is faster
-                    ang = vecAccel2.x;
-                    vecAccel2.x = -vecAccel2.y;
-                    vecAccel2.y = ang;
-
-                    vecAccel2 *= p.tangentialAccel;
-                    p.velocity += (vecAccel + vecAccel2) * delta;
-                    p.velocity.y += p.gravity * delta;
-
-                    p.pos += p.velocity * delta;
-
-                    p.spin += p.spinDelta * delta;
-                    p.size += p.sizeDelta * delta;
-                    p.color += p.colorDelta * delta;
-                }
-            }
-            idx = next;
-        }
+        particles.UpdateAge(delta);
+        particles.Integrate(pos, delta, 0, particles.len);
 
         // generate new particles
 
@@ -70,15 +298,17 @@ namespace xx {
             const auto particlesNeeded = cfg->emission * delta + emissionResidue;
             int n = (uint32_t)particlesNeeded;
             emissionResidue = particlesNeeded - n;
-            auto&& rnd = engine.rnd;
 
-            auto left = particles.Left();
-            if (n > left) {
-                n = left;
+            if (auto lim = std::min(particles.Left(), spawnLimit); (size_t)n > lim) {
+                auto denied = n - (int)lim;
+                deniedCount += denied;
+                if (denyPolicy == ParticleDenyPolicies::Defer) {
+                    emissionResidue = std::min(emissionResidue + denied, (float)cfg->emission);
+                }
+                n = (int)lim;
             }
+            ParticleItem p;
             for (i = 0; i < n; i++) {
-                auto&& p = particles.Add();
-
                 p.age = 0.0f;
                 p.terminalAge = rnd.Next(cfg->particleLife);
 
@@ -107,6 +337,10 @@ namespace xx {
                 p.color.a = rnd.Next2(cfg->color.first.a, cfg->color.first.a + (cfg->color.second.a - cfg-> color.first.a) * cfg->alphaVar);
 
                 p.colorDelta = (cfg->color.second - p.color) / p.terminalAge;
+                if (!particles.Add(p)) {
+                    deniedCount += n - i;   // pool is empty
+                    break;
+                }
             }
         }
 
@@ -118,8 +352,12 @@ namespace xx {
         if (moveParticles) {
             const auto d = xy - pos;
 
-            for (auto idx = particles.head; idx != -1; idx = particles.Next(idx)) {
-                particles[idx].pos += d;
+            for (size_t bi = 0, n = particles.blocks.size(); bi < n; ++bi) {
+                auto px = particles.Field(bi, ParticleItems::PosX), py = particles.Field(bi, ParticleItems::PosY);
+                for (size_t i = 0, e = std::min(ParticleItems::bs, particles.len - bi * ParticleItems::bs); i < e; ++i) {
+                    px[i] += d.x;
+                    py[i] += d.y;
+                }
             }
 
             prevPos += d;
@@ -155,6 +393,34 @@ namespace xx {
         }
     }
 
+    void Particle::Emit(Shader_QuadInstance& shader) const {
+        using F = ParticleItems;
+        auto&& ps = particles;
+        auto&& sprite = cfg->sprite;
+        auto alphaOnly = cfg->color.first.r < 0;
+        for (size_t bi = 0, nb = ps.blocks.size(); bi < nb; ++bi) {
+            auto n = std::min(F::bs, ps.len - bi * F::bs);  // block size < maxQuadNums
+            auto q = shader.Draw(*sprite.tex, (int)n);
+            auto posX = ps.Field(bi, F::PosX), posY = ps.Field(bi, F::PosY), size = ps.Field(bi, F::Size), spin = ps.Field(bi, F::Spin), age = ps.Field(bi, F::Age);
+            auto r = ps.Field(bi, F::ColorR), g = ps.Field(bi, F::ColorG), b = ps.Field(bi, F::ColorB), a = ps.Field(bi, F::ColorA);
+            for (size_t i = 0; i < n; ++i, ++q) {
+                q->pos = { posX[i] * scale + rootPos.x, posY[i] * scale + rootPos.y };
+                q->anchor = sprite.anchor;
+                q->scale.x = q->scale.y = size[i] * scale;
+                q->radians = spin[i] * age[i];
+                if (alphaOnly) {
+                    q->color = { sprite.color.r, sprite.color.g, sprite.color.b, (uint8_t)(a[i] * 255) };
+                } else {
+                    q->color = RGBA{ r[i], g[i], b[i], a[i] };
+                }
+                q->texRectX = sprite.texRectX;
+                q->texRectY = sprite.texRectY;
+                q->texRectW = sprite.texRectW;
+                q->texRectH = sprite.texRectH;
+            }
+        }
+    }
+
     void Particle::Draw() {
         std::pair<uint32_t, uint32_t> blendBak{};
         if (engine.blendFuncs != blendFuncs) {
@@ -163,27 +429,139 @@ namespace xx {
             engine.GLBlendFunc(blendFuncs);
         }
 
-        auto bak = cfg->sprite.color;
+        Emit(engine.sm.GetShader<Shader_QuadInstance>());
 
-        for (auto idx = particles.head; idx != -1; idx = particles.Next(idx)) {
-            auto&& par = particles[idx];
+        if (blendBak.first) {
+            engine.sm.End();
+            engine.GLBlendFunc(blendBak);
+        }
+    }
 
-            if (cfg->color.first.r < 0) {
-                cfg->sprite.color.a = par.color.a * 255;
-            } else {
-                cfg->sprite.color = par.color;
+    void Particle::Draw(std::span<Particle* const> const& ps) {
+        if (ps.empty()) return;
+        std::vector<Particle*> sorted(ps.begin(), ps.end());
+        std::stable_sort(sorted.begin(), sorted.end(), [](Particle* const& a, Particle* const& b) {
+            if (a->blendFuncs != b->blendFuncs) return a->blendFuncs < b->blendFuncs;
+            return (GLuint)*a->cfg->sprite.tex < (GLuint)*b->cfg->sprite.tex;
+        });
+
+        auto blendBak = engine.blendFuncs;
+        auto&& shader = engine.sm.GetShader<Shader_QuadInstance>();
+        for (auto&& p : sorted) {
+            if (!p->particles.len) continue;
+            if (engine.blendFuncs != p->blendFuncs) {
+                engine.sm.End();
+                engine.GLBlendFunc(p->blendFuncs);
             }
-            cfg->sprite.SetPosition(par.pos * scale + rootPos)
-                .SetScale(par.size * scale)
-                .SetRotate(par.spin * par.age)
-                .Draw();
+            p->Emit(shader);    // same texture: Shader_QuadInstance::Draw keep appending to the batch
         }
-
-        cfg->sprite.SetColor(bak);
-
-        if (blendBak.first) {
+        if (engine.blendFuncs != blendBak) {
             engine.sm.End();
             engine.GLBlendFunc(blendBak);
         }
     }
+
+    void ParticleSystem::Init(uint64_t const& seed_, size_t const& numThreads_, size_t const& budget, size_t const& numBlocks) {
+        Clear();
+        pool = xx::Make<ParticlePool>();
+        pool->Init(budget, numBlocks);
+        seed = seed_;
+        numThreads = numThreads_ ? numThreads_ : std::max<size_t>(1, std::thread::hardware_concurrency());
+        tp.reset();
+        if (numThreads > 1) {
+            tp = std::make_unique<ThreadPool<>>((int)numThreads - 1);
+        }
+    }
+
+    Particle& ParticleSystem::Add(xx::Shared<ParticleConfig> cfg, size_t const& cap, std::pair<uint32_t, uint32_t> blendFuncs) {
+        auto&& p = emitters.emplace_back(xx::Make<Particle>());
+        p->Init(std::move(cfg), cap, blendFuncs, seed + emitters.size(), pool);
+        return *p;
+    }
+
+    void ParticleSystem::Clear() {
+        emitters.clear();
+    }
+
+    void ParticleSystem::Update(float const& delta) {
+        // grant spawns by budget & free blocks in emitters order ( counts of last frame, a little conservative )
+        // so Alloc never fail in threads, which emitter get denied doesn't depend on thread timing
+        constexpr auto bs = ParticlePool::blockSize;
+        auto remain = pool->budget;
+        for (auto&& p : emitters) {
+            remain -= std::min(remain, p->particles.len);
+        }
+        auto freeBlocks = pool->numBlocks - pool->GetUsedBlocks();
+        for (auto&& p : emitters) {
+            auto&& ps = p->particles;
+            auto n = std::min({ remain, p->PeekSpawnCount(delta), ps.Left() });
+            auto have = ps.blocks.size() * bs - ps.len;
+            if (n > have) {
+                auto need = (n - have + bs - 1) / bs;
+                if (need > freeBlocks) {
+                    need = freeBlocks;
+                    n = have + need * bs;
+                }
+                freeBlocks -= need;
+            }
+            p->spawnLimit = n;
+            remain -= n;
+        }
+
+        if (numThreads <= 1 || emitters.size() <= 1) {
+            for (auto&& p : emitters) {
+                p->Update(delta);
+            }
+            return;
+        }
+        // emitters are independent: grab by index, no matter which thread run it
+        std::atomic<size_t> cursor{};
+        auto job = [&] {
+            for (size_t i; (i = cursor++) < emitters.size();) {
+                emitters[i]->Update(delta);
+            }
+        };
+        auto n = std::min(numThreads, emitters.size());
+        std::latch done((ptrdiff_t)n - 1);
+        for (size_t i = 1; i < n; ++i) {
+            tp->Add([&] {
+                job();
+                done.count_down();
+            });
+        }
+        job();
+        done.wait();
+    }
+
+    void ParticleSystem::Draw() {
+        std::vector<Particle*> ps;
+        ps.reserve(emitters.size());
+        for (auto&& p : emitters) {
+            ps.push_back(p.pointer);
+        }
+        Particle::Draw(ps);
+    }
+
+    size_t ParticleSystem::GetParticleCount() const {
+        size_t n{};
+        for (auto&& p : emitters) {
+            n += p->particles.len;
+        }
+        return n;
+    }
+
+    ParticleSystem::Stats ParticleSystem::GetStats() const {
+        Stats s{};
+        s.alive = GetParticleCount();
+        s.budget = pool->budget;
+        s.usedBlocks = pool->GetUsedBlocks();
+        s.peakUsedBlocks = pool->peakUsedBlocks;
+        s.numBlocks = pool->numBlocks;
+        for (auto&& p : emitters) {
+            s.denied += p->deniedCount;
+        }
+        s.blockFill = s.usedBlocks ? float(s.alive) / (s.usedBlocks * ParticlePool::blockSize) : 0.f;
+        s.budgetUsage = s.budget ? float(s.alive) / s.budget : 0.f;
+        return s;
+    }
 }
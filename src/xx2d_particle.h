@@ -1,17 +1,87 @@
 ﻿#pragma once
 #include "xx2d.h"
-#include "xx_listlink.h"
 
 namespace xx {
 
 	// code ref from HGE
 
+	// spawn / read value. storage is ParticleItems ( SoA )
 	struct ParticleItem {
 		XY pos, velocity;
 		float gravity, radialAccel, tangentialAccel, spin, spinDelta, size, sizeDelta, age, terminalAge;
 		RGBA color, colorDelta; // + alpha
 	};
 
+	// fixed arena of SoA blocks shared by emitters. memory is allocated once by Init, Alloc / Free only move block pointers
+	// block layout: numFields arrays of blockSize floats. field f of slot s == block[f * blockSize + s]
+	struct ParticlePool {
+		static constexpr size_t numFields = 21;
+		static constexpr size_t blockSize = 256;	// multiple of 8 ( simd )
+		std::unique_ptr<float[]> buf;
+		std::vector<float*> freeBlocks;
+		std::mutex mtx;
+		size_t numBlocks{};
+		size_t budget{};				// max alive particles of all emitters ( ParticleSystem grant spawns by it )
+		size_t peakUsedBlocks{};
+
+		// numBlocks_ 0: enough for budget + 64 emitters' partial blocks
+		void Init(size_t const& budget_, size_t numBlocks_ = 0);
+
+		// thread safe. return nullptr: empty
+		float* Alloc();
+		void Free(float* const& b);
+
+		size_t GetUsedBlocks();
+	};
+
+	// one emitter's particles: SoA blocks from pool, alive items are [0, len). Remove move the last item into the hole ( order not kept )
+	// benchmark: bench/particle_items.cpp
+	struct ParticleItems {
+		enum Fields : size_t {
+			PosX, PosY, VelocityX, VelocityY, Gravity, RadialAccel, TangentialAccel, Spin, SpinDelta, Size, SizeDelta, Age, TerminalAge
+			, ColorR, ColorG, ColorB, ColorA, ColorDeltaR, ColorDeltaG, ColorDeltaB, ColorDeltaA
+		};
+		static constexpr size_t bs = ParticlePool::blockSize;
+
+		xx::Shared<ParticlePool> pool;
+		std::vector<float*> blocks;
+		size_t len{}, cap{};			// cap: max alive of this emitter
+
+		ParticleItems() = default;
+		ParticleItems(ParticleItems const&) = delete;
+		ParticleItems& operator=(ParticleItems const&) = delete;
+		~ParticleItems();
+
+		// clear, then use pool_ ( null: create a private pool for cap_ )
+		void Init(xx::Shared<ParticlePool> pool_, size_t const& cap_);
+
+		// return blocks to pool
+		void Clear();
+		size_t Left() const {
+			return cap - len;
+		}
+
+		// return false: pool is empty
+		bool Add(ParticleItem const& o);
+		void Remove(size_t const& i);
+		ParticleItem operator[](size_t const& i) const;
+
+		float* Field(size_t const& blockIndex, Fields const& f) const {
+			return blocks[blockIndex] + f * bs;
+		}
+		float& At(Fields const& f, size_t const& i) const {
+			return blocks[i / bs][f * bs + i % bs];
+		}
+
+		// age += delta. remove dead items
+		void UpdateAge(float const& delta);
+
+		// accel, velocity, spin, size, color integrate for items [begin, end). center: emitter's pos
+		// simd ( AVX2 when XX2D_ENABLE_AVX2, else SSE2 ) & scalar paths use the same op order, results are identical
+		// as long as the compiler doesn't contract mul + add into fma ( cmake builds this file with -ffp-contract=off )
+		void Integrate(XY const& center, float const& delta, size_t begin, size_t const& end);
+	};
+
 	struct ParticleConfig {
 		Quad sprite;
 
@@ -38,11 +108,21 @@ namespace xx {
 		float colorVar, alphaVar;	// 0 ~ 1
 	};
 
+	enum class ParticleDenyPolicies : uint8_t {
+		Drop,	// lost
+		Defer	// keep in emissionResidue ( up to 1 second of emission ), spawn when budget free
+	};
+
 	struct Particle {
 
-		void Init(xx::Shared<ParticleConfig> cfg_, size_t const& cap = 1000, std::pair<uint32_t, uint32_t> blendFuncs_ = { GL_ONE, GL_ONE_MINUS_SRC_ALPHA });
+		// seed: for rnd. 0: take one from engine.rnd. pool: null: private pool for cap
+		void Init(xx::Shared<ParticleConfig> cfg_, size_t const& cap = 1000, std::pair<uint32_t, uint32_t> blendFuncs_ = { GL_ONE, GL_ONE_MINUS_SRC_ALPHA }
+			, uint64_t const& seed = 0, xx::Shared<ParticlePool> pool = {});
 		void Update(float delta);
 
+		// how many particles next Update( delta ) want to spawn ( no state change )
+		size_t PeekSpawnCount(float const& delta) const;
+
 		void FireAt(XY const& xy);
 		void Fire();
 		void MoveTo(XY const& xy, bool moveParticles = false);
@@ -50,12 +130,56 @@ namespace xx {
 
 		void Draw();
 
+		// fill all alive particles into instance memory in chunks of maxQuadNums. blend funcs not touched. benchmark: bench/particle_emit.cpp
+		void Emit(Shader_QuadInstance& shader) const;
+
+		// draw many emitters grouped by blend funcs & texture. switch blend funcs only between groups
+		static void Draw(std::span<Particle* const> const& ps);
+
 		xx::Shared<ParticleConfig> cfg;
 		std::pair<uint32_t, uint32_t> blendFuncs;
 
-		xx::ListLink<ParticleItem, int> particles;
+		ParticleItems particles;
+		SmallRnd rnd;	// own generator: emitters can Update on different threads, result only depend on seed
+
+		// spawns over min( cap, pool, spawnLimit ) are denied
+		size_t spawnLimit = std::numeric_limits<size_t>::max();	// set by ParticleSystem per frame
+		ParticleDenyPolicies denyPolicy{};
+		uint64_t deniedCount{};		// sum of denied spawns per Update ( Defer: waiting ones count again next frame )
 
 		float age, emissionResidue, scale;
 		XY prevPos, pos, rootPos;
 	};
+
+	// owns emitters. Update spread emitters to threads. every emitter use its own rnd ( seed + index ), result is the same for any numThreads
+	// all emitters share one pool. spawns are granted by pool's budget in emitters order before the threaded update ( deterministic too )
+	// benchmark: bench/particle_system.cpp ( threads, shared pool & budget )
+	struct ParticleSystem {
+		std::vector<xx::Shared<Particle>> emitters;
+		xx::Shared<ParticlePool> pool;
+		uint64_t seed{};
+		size_t numThreads{};	// 0: hardware_concurrency
+		std::unique_ptr<ThreadPool<>> tp;	// numThreads - 1 persistent workers. Update's caller is the last one
+
+		void Init(uint64_t const& seed_, size_t const& numThreads_ = 0, size_t const& budget = 100000, size_t const& numBlocks = 0);
+
+		// create & Init an emitter. rnd's seed = seed + emitters.size()
+		Particle& Add(xx::Shared<ParticleConfig> cfg, size_t const& cap = 1000, std::pair<uint32_t, uint32_t> blendFuncs = { GL_ONE, GL_ONE_MINUS_SRC_ALPHA });
+		void Clear();
+
+		void Update(float const& delta);
+
+		// grouped by blend funcs & texture
+		void Draw();
+
+		size_t GetParticleCount() const;
+
+		struct Stats {
+			size_t alive, budget, usedBlocks, peakUsedBlocks, numBlocks;
+			uint64_t denied;
+			float blockFill;			// alive / ( usedBlocks * blockSize )
+			float budgetUsage;			// alive / budget
+		};
+		Stats GetStats() const;
+	};
 }
@@ -1,13 +1,82 @@
 ﻿#pragma once
 #include "xx2d.h"
 #include <random>
+#include <bit>
 
 namespace xx {
 
+    // Next overloads for any generator which has uint32_t Get()
+    template<typename T>
+    struct RndNexts {
+        uint32_t GetU32() {
+            return static_cast<T*>(this)->Get();
+        }
+
+        template<typename V = int32_t, class = std::enable_if_t<std::is_arithmetic_v<V>>>
+        V Next() {
+            if constexpr (std::is_same_v<bool, std::decay_t<V>>) {
+                return GetU32() >= std::numeric_limits<uint32_t>::max() / 2;
+            } else if constexpr (std::is_integral_v<V>) {
+                std::make_unsigned_t<V> v;
+                if constexpr (sizeof(V) <= 4) {
+                    v = (V)GetU32();
+                } else {
+                    v = (V)(GetU32() | ((uint64_t)GetU32() << 32));
+                }
+                if constexpr (std::is_signed_v<V>) {
+                    return (V)(v & std::numeric_limits<V>::max());
+                } else return (V)v;
+            } else if constexpr (std::is_floating_point_v<V>) {
+                if constexpr (sizeof(V) == 4) {
+                    return (float)(double(GetU32()) / 0xFFFFFFFFu);
+                } else if constexpr (sizeof(V) == 8) {
+                    constexpr auto max53 = (1ull << 53) - 1;
+                    auto v = ((uint64_t)GetU32() << 32) | GetU32();
+                    return double(v & max53) / max53;
+                }
+            }
+            assert(false);
+        }
+
+        template<typename V>
+        V Next(V const& from, V const& to) {
+            if (from == to) return from;
+            assert(from < to);
+            if constexpr (std::is_floating_point_v<V>) {
+                return from + Next<V>() * (to - from);
+            } else {
+                return from + Next<V>() % (to - from + 1);
+            }
+        }
+
+        template<typename V>
+        V Next2(V from, V to) {
+            if (from == to) return from;
+            if (to < from) {
+                std::swap(from, to);
+            }
+            if constexpr (std::is_floating_point_v<V>) {
+                return from + Next<V>() * (to - from);
+            } else {
+                return from + Next<V>() % (to - from + 1);
+            }
+        }
+
+        template<typename V>
+        V Next(V const& to) {
+            return Next((V)0, to);
+        }
+
+        template<typename V>
+        V Next(std::pair<V, V> const& fromTo) {
+            return Next(fromTo.first, fromTo.second);
+        }
+    };
+
     // reference from https://github.com/cslarsen/mersenne-twister
     // faster than std impl, can store & restore state data directly
     // ser/de data size == 5000 bytes
-    struct Rnd {
+    struct Rnd : RndNexts<Rnd> {
 
 #pragma region impl
         inline static const size_t SIZE = 624;
@@ -103,66 +172,234 @@ namespace xx {
             }
             return s;
         }
+    };
 
-        template<typename V = int32_t, class = std::enable_if_t<std::is_arithmetic_v<V>>>
-        V Next() {
-            if constexpr (std::is_same_v<bool, std::decay_t<V>>) {
-                return Get() >= std::numeric_limits<uint32_t>::max() / 2;
-            } else if constexpr (std::is_integral_v<V>) {
-                std::make_unsigned_t<V> v;
-                if constexpr (sizeof(V) <= 4) {
-                    v = (V)Get();
-                } else {
-                    v = (V)(Get() | ((uint64_t)Get() << 32));
-                }
-                if constexpr (std::is_signed_v<V>) {
-                    return (V)(v & std::numeric_limits<V>::max());
-                } else return (V)v;
-            } else if constexpr (std::is_floating_point_v<V>) {
-                if constexpr (sizeof(V) == 4) {
-                    return (float)(double(Get()) / 0xFFFFFFFFu);
-                } else if constexpr (sizeof(V) == 8) {
-                    constexpr auto max53 = (1ull << 53) - 1;
-                    auto v = ((uint64_t)Get() << 32) | Get();
-                    return double(v & max53) / max53;
-                }
-            }
-            assert(false);
+    // xoshiro128** ( https://prng.di.unimi.it/ ). 16 bytes state: cheap to copy / store, one per emitter / entity / thread
+    // faster than Rnd when only a few numbers needed per instance ( no 624 words Generate )
+    // can store & restore state data directly. ser/de data size == 16 bytes
+    // benchmark & quality checks: bench/rnd.cpp
+    struct SmallRnd : RndNexts<SmallRnd> {
+        // bulk fills shorter than this don't worth seeding the lanes
+        static constexpr size_t bulkMinLen = 64;
+        // lanes count of bulk fills. 8 * uint32 == one AVX2 register, two SSE2
+        static constexpr size_t numLanes = 8;
+
+        uint32_t s[4];
+
+        // fixed seed 0: no std::random_device open per instance ( members / arrays are cheap to make ). SetSeed for another sequence
+        SmallRnd() {
+            SetSeed(0);
         }
 
-        template<typename V>
-        V Next(V const& from, V const& to) {
-            if (from == to) return from;
-            assert(from < to);
-            if constexpr (std::is_floating_point_v<V>) {
-                return from + Next<V>() * (to - from);
-            } else {
-                return from + Next<V>() % (to - from + 1);
+        explicit SmallRnd(uint64_t const& seed) {
+            SetSeed(seed);
+        }
+
+        // expand seed by splitmix64. any seed ( include 0 ) is ok
+        void SetSeed(uint64_t seed) {
+            for (size_t i = 0; i < 4; i += 2) {
+                auto z = (seed += 0x9e3779b97f4a7c15);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+                z = z ^ (z >> 31);
+                s[i] = (uint32_t)z;
+                s[i + 1] = (uint32_t)(z >> 32);
             }
         }
 
-        template<typename V>
-        V Next2(V from, V to) {
-            if (from == to) return from;
-            if (to < from) {
-                std::swap(from, to);
+        uint32_t Get() {
+            auto r = Rotl(s[1] * 5, 7) * 9;
+            auto t = s[1] << 9;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = Rotl(s[3], 11);
+            return r;
+        }
+
+        // equivalent to 2^64 Get() calls
+        void Jump() {
+            static constexpr uint32_t jumps[] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+            uint32_t t[4]{};
+            for (auto& j : jumps) {
+                for (int b = 0; b < 32; ++b) {
+                    if (j & (1u << b)) {
+                        t[0] ^= s[0];
+                        t[1] ^= s[1];
+                        t[2] ^= s[2];
+                        t[3] ^= s[3];
+                    }
+                    Get();
+                }
             }
-            if constexpr (std::is_floating_point_v<V>) {
-                return from + Next<V>() * (to - from);
-            } else {
-                return from + Next<V>() % (to - from + 1);
+            memcpy(s, t, sizeof(s));
+        }
+
+        // return a copy for another thread, then jump: the 2 sequences never overlap ( up to 2^64 numbers )
+        SmallRnd Fork() {
+            auto r = *this;
+            Jump();
+            return r;
+        }
+
+        // [0, 1). 23 bits mantissa, never return 1 ( Next<float>() may )
+        float NextFloat() {
+            return ToFloat(Get());
+        }
+
+        // [from, to)
+        float NextFloat(float const& from, float const& to) {
+            return from + NextFloat() * (to - from);
+        }
+
+        // [0, n). unbiased ( Lemire's multiply + reject ), n == 0 means full 2^32
+        uint32_t NextBounded(uint32_t const& n) {
+            if (!n) return Get();
+            return Bounded((uint64_t)Get() * n, n);
+        }
+
+        // [from, to]. unbiased ( Next(from, to) use % )
+        int32_t NextInt(int32_t const& from, int32_t const& to) {
+            assert(from <= to);
+            return (int32_t)((uint32_t)from + NextBounded((uint32_t)to - (uint32_t)from + 1));   // unsigned add: no signed overflow
+        }
+
+        // bulk fills. long spans are filled by numLanes generators seeded from this ( vectorizable )
+        // result only depend on state & span size
+        void NextU32s(std::span<uint32_t> const& out) {
+            Fill(out.data(), out.size(), [](uint32_t const* t, uint32_t* o, size_t n) {
+                for (size_t k = 0; k < n; ++k) {
+                    o[k] = t[k];
+                }
+            });
+        }
+
+        // [0, 1)
+        void NextFloats(std::span<float> const& out) {
+            Fill(out.data(), out.size(), [](uint32_t const* t, float* o, size_t n) {
+                for (size_t k = 0; k < n; ++k) {
+                    o[k] = ToFloat(t[k]);
+                }
+            });
+        }
+
+        // [from, to)
+        void NextFloats(std::span<float> const& out, float const& from, float const& to) {
+            auto d = to - from;
+            Fill(out.data(), out.size(), [from, d](uint32_t const* t, float* o, size_t n) {
+                auto f = from, fd = d;  // locals: o can't alias them, loop vectorize
+                for (size_t k = 0; k < n; ++k) {
+                    o[k] = f + ToFloat(t[k]) * fd;
+                }
+            });
+        }
+
+        // [from, to]. unbiased: rejected numbers ( rare, < range / 2^32 ) are redone by Get()
+        void NextInts(std::span<int32_t> const& out, int32_t const& from, int32_t const& to) {
+            assert(from <= to);
+            auto n = (uint32_t)to - (uint32_t)from + 1;
+            if (!n) {   // full range
+                Fill(out.data(), out.size(), [from](uint32_t const* t, int32_t* o, size_t c) {
+                    auto f = (uint32_t)from;
+                    for (size_t k = 0; k < c; ++k) {
+                        o[k] = (int32_t)(f + t[k]);
+                    }
+                });
+                return;
             }
+            auto threshold = (0u - n) % n;
+            Fill(out.data(), out.size(), [this, from, n, threshold](uint32_t const* t, int32_t* o, size_t c) {
+                auto f = (uint32_t)from;
+                auto fn = n, ft = threshold;
+                uint32_t rejected = 0;
+                for (size_t k = 0; k < c; ++k) {
+                    auto m = (uint64_t)t[k] * fn;
+                    rejected |= (uint32_t)((uint32_t)m < ft);
+                    o[k] = (int32_t)(f + (uint32_t)(m >> 32));
+                }
+                if (rejected) {
+                    for (size_t k = 0; k < c; ++k) {
+                        auto m = (uint64_t)t[k] * n;
+                        if ((uint32_t)m < threshold) {
+                            o[k] = (int32_t)((uint32_t)from + Bounded(m, n));
+                        }
+                    }
+                }
+            });
         }
 
-        template<typename V>
-        V Next(V const& to) {
-            return Next((V)0, to);
+    protected:
+        static uint32_t Rotl(uint32_t const& x, int const& k) {
+            return (x << k) | (x >> (32 - k));
         }
 
-        template<typename V>
-        V Next(std::pair<V, V> const& fromTo) {
-            return Next(fromTo.first, fromTo.second);
+        // 1.xxx by exponent bits, then - 1
+        static float ToFloat(uint32_t const& x) {
+            return std::bit_cast<float>((x >> 9) | 0x3f800000u) - 1.f;
         }
-    };
 
+        // m == x * n, n > 0
+        uint32_t Bounded(uint64_t m, uint32_t const& n) {
+            if (auto l = (uint32_t)m; l < n) {
+                for (auto threshold = (0u - n) % n; l < threshold; l = (uint32_t)m) {
+                    m = (uint64_t)Get() * n;
+                }
+            }
+            return (uint32_t)(m >> 32);
+        }
+
+        // SoA state of numLanes xoshiro128**. same Get() steps, plain loops: compiler vectorize them
+        struct Lanes {
+            alignas(32) uint32_t s0[numLanes], s1[numLanes], s2[numLanes], s3[numLanes];
+
+            void Get(uint32_t* o) {
+                for (size_t k = 0; k < numLanes; ++k) {
+                    auto r = Rotl(s1[k] * 5, 7) * 9;
+                    auto t = s1[k] << 9;
+                    s2[k] ^= s0[k];
+                    s3[k] ^= s1[k];
+                    s1[k] ^= s2[k];
+                    s0[k] ^= s3[k];
+                    s2[k] ^= t;
+                    s3[k] = Rotl(s3[k], 11);
+                    o[k] = r;
+                }
+            }
+        };
+
+        // f( uint32_t const* src, T* dst, size_t len ) convert up to numLanes numbers
+        template<typename T, typename F>
+        void Fill(T* p, size_t len, F&& f) {
+            alignas(32) uint32_t t[numLanes];
+            if (len < bulkMinLen) {
+                for (size_t i = 0; i < len; i += numLanes) {
+                    auto n = std::min(numLanes, len - i);
+                    for (size_t k = 0; k < n; ++k) {
+                        t[k] = Get();
+                    }
+                    f(t, p + i, n);
+                }
+                return;
+            }
+            Lanes ls;
+            for (size_t k = 0; k < numLanes; ++k) {
+                SmallRnd r(((uint64_t)Get() << 32) | Get());
+                ls.s0[k] = r.s[0];
+                ls.s1[k] = r.s[1];
+                ls.s2[k] = r.s[2];
+                ls.s3[k] = r.s[3];
+            }
+            size_t i = 0;
+            for (; i + numLanes <= len; i += numLanes) {
+                ls.Get(t);
+                f(t, p + i, numLanes);
+            }
+            if (i < len) {
+                ls.Get(t);
+                f(t, p + i, len - i);
+            }
+        }
+    };
 }
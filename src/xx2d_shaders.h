@@ -223,13 +223,21 @@ namespace xx {
 		GLint uCxy = -1, uStrideHeight = -1, uTexY = -1, uTexU = -1, uTexV = -1, uTexA = -1, aPos = -1, aTexCoord = -1;
 		GLVertexArrays va;
 		GLBuffer vb, ib;
+		GLTexture texY, texU, texV, texA;	// for Draw( xxxData ... ). reuse when size not changed
 
 		static void Init();
 		void Init(ShaderManager*) override;
 		void Begin() override;
 		void End() override;
 
+		// upload plane data to t & bind to textureUnit. create t when empty or w h changed, else glTexSubImage2D. data == nullptr: 1x1 white
+		static void Upload(GLTexture& t, int const& textureUnit, GLsizei const& w, GLsizei const& h, void const* const& data);
+
+		// upload to texY, texU, texV, texA then draw
 		void Draw(uint8_t const* const& yData, uint8_t const* const& uData, uint8_t const* const& vData, uint8_t const* const& aData, uint32_t const& yaStride, uint32_t const& uvStride, uint32_t const& w, uint32_t const& h, XY const& pos);
+
+		// draw by uploaded textures
+		void Draw(GLuint const& tY, GLuint const& tU, GLuint const& tV, GLuint const& tA, uint32_t const& yaStride, uint32_t const& w, uint32_t const& h, XY const& pos);
 	};
 
 
@@ -99,7 +99,37 @@ void main() {
 	void Shader_Yuva2Rgba::End() {}
 
 
+	void Shader_Yuva2Rgba::Upload(GLTexture& t, int const& textureUnit, GLsizei const& w, GLsizei const& h, void const* const& data) {
+		static const uint8_t white = 255;
+		auto d = data;
+		auto tw = w, th = h;
+		if (!d) {
+			d = &white;
+			tw = th = 1;
+		}
+		if (!t || std::get<1>(t.vs) != tw || std::get<2>(t.vs) != th) {
+			t = GLTexture(LoadGLTexture_core(textureUnit), tw, th, std::string());
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, tw, th, 0, GL_RED, GL_UNSIGNED_BYTE, d);
+		} else {
+			glActiveTexture(GL_TEXTURE0 + textureUnit);
+			glBindTexture(GL_TEXTURE_2D, t);
+			if (data) {
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tw, th, GL_RED, GL_UNSIGNED_BYTE, d);
+			}
+		}
+		CheckGLError();
+	}
+
 	void Shader_Yuva2Rgba::Draw(uint8_t const* const& yData, uint8_t const* const& uData, uint8_t const* const& vData, uint8_t const* const& aData, uint32_t const& yaStride, uint32_t const& uvStride, uint32_t const& w, uint32_t const& h, XY const& pos) {
+		auto uvh = (h + 1) / 2;
+		Upload(texY, 0, yaStride, h, yData);
+		Upload(texU, 1, uvStride, uvh, uData);
+		Upload(texV, 2, uvStride, uvh, vData);
+		Upload(texA, 3, yaStride, h, aData);
+		Draw(texY, texU, texV, texA, yaStride, w, h, pos);
+	}
+
+	void Shader_Yuva2Rgba::Draw(GLuint const& tY, GLuint const& tU, GLuint const& tV, GLuint const& tA, uint32_t const& yaStride, uint32_t const& w, uint32_t const& h, XY const& pos) {
 
 		glUseProgram(p);
 		glUniform2f(uCxy, 2 / engine.w, 2 / engine.h);
@@ -137,21 +167,11 @@ void main() {
 		xyuv[3].u = w;
 		xyuv[3].v = 0;
 
-		auto texY = LoadGLTexture_core(0);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, yaStride, h, 0, GL_RED, GL_UNSIGNED_BYTE, yData);
-		CheckGLError();
-
-		auto texU = LoadGLTexture_core(1);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, uvStride, h / 2, 0, GL_RED, GL_UNSIGNED_BYTE, uData);
-		CheckGLError();
-
-		auto texV = LoadGLTexture_core(2);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, uvStride, h / 2, 0, GL_RED, GL_UNSIGNED_BYTE, vData);
-		CheckGLError();
-
-		auto texA = LoadGLTexture_core(3);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, yaStride, h, 0, GL_RED, GL_UNSIGNED_BYTE, aData);
-		CheckGLError();
+		GLuint ts[4] = { tY, tU, tV, tA };
+		for (int i = 0; i < 4; ++i) {
+			glActiveTexture(GL_TEXTURE0 + i);
+			glBindTexture(GL_TEXTURE_2D, ts[i]);
+		}
 
 		glBindBuffer(GL_ARRAY_BUFFER, vb);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(xyuv), xyuv, GL_STREAM_DRAW);
@@ -6,20 +6,22 @@ namespace xx {
 	namespace TMX {
 
 		struct Filler {
-			// fill data by .tmx file
-			Filler(Map& map, std::string_view tmxfn);
+			// fill data by .tmx file's content
+			Filler(Map& map, xx::Data const& d, std::string rootPath_, FillOptions const& opts);
 
 			int rtv = 0;
 			Map& map;
+			FillOptions opts;
 			pugi::xml_document docTmx, docTsx, docTx;
 			std::string rootPath;
 			std::unordered_map<uint32_t, Object*> objs;	// store all objs cross Layer_Object
-			std::vector<std::pair<std::vector<Property>*, size_t>> objProps;	// store properties[ idx ] need replace id to obj
+			std::vector<std::pair<Properties*, size_t>> objProps;	// store properties[ idx ] need replace id to obj
+			std::unordered_map<std::string, Image*> images;	// key: source. for fast TryFillImage
 
 			// for easy Fill
-			void TryFillProperties(std::vector<Property>& out, pugi::xml_node const& owner, bool needOverride = false);
+			void TryFillProperties(Properties& out, pugi::xml_node const& owner, bool needOverride = false);
 			void TryFillImage(xx::Shared<Image>& out, pugi::xml_node const& c);
-			Property* MakeProperty(std::vector<Property>& out, pugi::xml_node const& c, std::string&& name);
+			Property* MakeProperty(Properties& out, pugi::xml_node const& c, std::string&& name);
 			void TryFillTileset(Tileset& ts, pugi::xml_node const& c);
 			void TryFillLayerBase(Layer& L, pugi::xml_node const& c);
 			void TryFillLayer(Layer_Tile& L, pugi::xml_node const& c);
@@ -327,27 +329,23 @@ namespace xx {
 			TryFill(chunk.height, cChunk.attribute("height"));
 		}
 
-		Property* Filler::MakeProperty(std::vector<Property>& out, pugi::xml_node const& c, std::string&& name) {
+		Property* Filler::MakeProperty(Properties& out, pugi::xml_node const& c, std::string&& name) {
 			auto&& p = &out.emplace_back();
 			p->name = std::move(name);
+			p->nameHash = std::hash<std::string_view>{}(p->name);
 			p->type = PropertyTypes::String;
 			TryFill(p->type, c.attribute("type"));
 			return p;
 		}
 
-		void Filler::TryFillProperties(std::vector<Property>& out, pugi::xml_node const& owner, bool needOverride) {
+		void Filler::TryFillProperties(Properties& out, pugi::xml_node const& owner, bool needOverride) {
 			for (auto&& c : owner.child("properties").children("property")) {
 				Property* p;
 				if (needOverride) {
 					std::string name;
 					TryFill(name, c.attribute("name"));
-					auto&& iter = std::find_if(out.begin(), out.end(), [&](Property const& prop) {
-						return prop.name == name;
-						});
-					if (iter == out.end()) {
+					if (p = FindProperty(out, name); !p) {
 						p = MakeProperty(out, c, std::move(name));
-					} else {
-						p = &*iter;
 					}
 				} else {
 					p = MakeProperty(out, c, c.attribute("name").as_string());
@@ -395,6 +393,7 @@ namespace xx {
 					throw std::logic_error("FillPropertiesTo error: unhandled property type: " + std::to_string((int)p->type));
 				}
 			}
+			out.BuildIndex();
 		}
 
 		void Filler::TryFillImage(xx::Shared<Image>& out, pugi::xml_node const& c) {
@@ -403,19 +402,19 @@ namespace xx {
 			std::string s;
 			TryFill(s, c.attribute("source"));
 			auto&& fp = rootPath + s;	// to fullpath
-			auto&& iter = std::find_if(map.images.begin(), map.images.end(), [&](xx::Shared<Image> const& img) {
-				return img->source == s;
-				});
-			if (iter == map.images.end()) {
+			if (auto&& iter = images.find(s); iter == images.end()) {
 				auto&& img = out.Emplace();
-				img->source = std::move(s);
-				img->texture.Emplace(engine.LoadTexture(fp));
+				img->source = s;
+				if (opts.loadTextures) {
+					img->texture.Emplace(engine.LoadTexture(fp));
+				}
 				TryFill(img->width, c.attribute("width"));
 				TryFill(img->height, c.attribute("height"));
 				TryFill(img->transparentColor, c.attribute("trans"));
 				map.images.push_back(img);
+				images.emplace(std::move(s), img.pointer);
 			} else {
-				out = *iter;
+				out = iter->second;
 			}
 		}
 
@@ -505,6 +504,7 @@ namespace xx {
 						}
 					}
 				}
+				ts.FillTilesById();
 			}
 		}
 
@@ -526,16 +526,31 @@ namespace xx {
 		void Filler::TryFillLayer(Layer_Tile& L, pugi::xml_node const& c) {
 			L.type = LayerTypes::TileLayer;
 			TryFillLayerBase(L, c);
+			L.width = map.width;
+			L.height = map.height;
+			TryFill(L.width, c.attribute("width"));
+			TryFill(L.height, c.attribute("height"));
 			auto&& [encoding, compression] = map.tileLayerFormat;
 			auto&& cData = c.child("data");
 			if (map.infinite) {
+				// streamChunks: compress every chunk right after parse, only 1 chunk's gids alive during load
+				std::vector<uint32_t> gids;
+				auto&& Commit = [&](Chunk& chunk) {
+					if (opts.streamChunks) {
+						ZstdCompress({ (char*)gids.data(), gids.size() * sizeof(uint32_t) }, chunk.zgids, opts.compressionLevel);
+						gids.clear();
+					} else {
+						std::swap(chunk.gids, gids);
+					}
+				};
 				switch (encoding) {
 				case Encodings::Csv:
 				{
 					for (auto&& cChunk : cData.children("chunk")) {
 						auto&& chunk = L.chunks.emplace_back();
 						TryFillChunkBase(chunk, cChunk);
-						FillCsvIntsTo(chunk.gids, cChunk.text().as_string());
+						FillCsvIntsTo(gids, cChunk.text().as_string());
+						Commit(chunk);
 					}
 					break;
 				}
@@ -549,13 +564,18 @@ namespace xx {
 						switch (compression) {
 						case Compressions::Uncompressed:
 						{
-							FillBinIntsTo(chunk.gids, { bin.data(), bin.size() });
+							FillBinIntsTo(gids, { bin.data(), bin.size() });
+							Commit(chunk);
 							break;
 						}
 						case Compressions::Zstd:
 						{
-							ZstdDecompress(bin, tmp);
-							FillBinIntsTo(chunk.gids, tmp);
+							if (opts.streamChunks) {
+								chunk.zgids.WriteBuf(bin.data(), bin.size());	// keep compressed
+							} else {
+								ZstdDecompress(bin, tmp);
+								FillBinIntsTo(chunk.gids, tmp);
+							}
 							break;
 						}
 						default:
@@ -572,8 +592,9 @@ namespace xx {
 						auto&& chunk = L.chunks.emplace_back();
 						TryFillChunkBase(chunk, cChunk);
 						for (auto&& cTile : cChunk.children("tile")) {
-							chunk.gids.push_back(cTile.attribute("gid").as_uint());
+							gids.push_back(cTile.attribute("gid").as_uint());
 						}
+						Commit(chunk);
 					}
 					break;
 				}
@@ -584,7 +605,7 @@ namespace xx {
 				switch (map.tileLayerFormat.encoding) {
 				case Encodings::Csv:
 				{
-					FillCsvIntsTo(L.gids, cData.text().as_string());
+					FillCsvIntsTo(L.denseGids, cData.text().as_string());
 					break;
 				}
 				case Encodings::Base64:
@@ -594,13 +615,13 @@ namespace xx {
 					switch (map.tileLayerFormat.compression) {
 					case Compressions::Uncompressed:
 					{
-						FillBinIntsTo(L.gids, { bin.data(), bin.size() });
+						FillBinIntsTo(L.denseGids, { bin.data(), bin.size() });
 						break;
 					}
 					case Compressions::Zstd:
 					{
 						ZstdDecompress(bin, tmp);
-						FillBinIntsTo(L.gids, tmp);
+						FillBinIntsTo(L.denseGids, tmp);
 						break;
 					}
 					default:
@@ -613,13 +634,19 @@ namespace xx {
 				case Encodings::Xml:
 				{
 					for (auto&& cTile : cData.children("tile")) {
-						L.gids.push_back(cTile.attribute("gid").as_uint());
+						L.denseGids.push_back(cTile.attribute("gid").as_uint());
 					}
 					break;
 				}
 				default:
 					throw std::logic_error("unsupported encoding: " + std::to_string((int)encoding));
 				};
+				if (L.denseGids.size() != (size_t)L.width * L.height) {
+					throw std::logic_error(xx::ToString("tile layer gids count error. layer name = ", L.name, ", count = ", L.denseGids.size()));
+				}
+				if (opts.sparseDensity > 0) {
+					L.TryMakeSparse(opts.sparseDensity);
+				}
 			}
 		}
 
@@ -780,18 +807,13 @@ namespace xx {
 		}
 
 		/**************************************************************************************************/
-		Filler::Filler(Map& map, std::string_view tmxfn)
-			: map(map) {
+		Filler::Filler(Map& map, xx::Data const& d, std::string rootPath_, FillOptions const& opts)
+			: map(map)
+			, opts(opts)
+			, rootPath(std::move(rootPath_)) {
 
-			// load file & calc rootPath
-			if (auto&& [d, fp] = engine.LoadFileData(tmxfn); !d) {
-				throw std::logic_error("read file error: " + std::string(tmxfn));
-			} else if (auto&& r = docTmx.load_buffer(d.buf, d.len); r.status) {
+			if (auto&& r = docTmx.load_buffer(d.buf, d.len); r.status) {
 				throw std::logic_error("docTmx.load_buffer error: " + std::string(r.description()));
-			} else {
-				if (auto&& i = fp.find_last_of("/"); i != fp.npos) {
-					rootPath = fp.substr(0, i + 1);
-				}
 			}
 
 			// fill step 1: parse xml to struct
@@ -856,6 +878,9 @@ namespace xx {
 					throw std::logic_error("unhandled layer type");
 				}
 			}
+			if (opts.indexObjects) {
+				BuildObjectIndexs(map);
+			}
 
 			// fill step 2: fix object ref
 
@@ -890,16 +915,10 @@ namespace xx {
 						auto gid = tileset->firstgid + id;
 						auto& info = map.gidInfos[gid];
 						info.tileset = tileset;
-						info.tile = nullptr;
+						info.tile = tileset->GetTile(id);
 						info.image = img;
-						for (auto& t : tileset->tiles) {
-							if (t->id == id) {
-								info.tile = t.get();
-								if (t->image) {
-									info.image = t->image;
-								}
-								break;
-							}
+						if (info.tile && info.tile->image) {
+							info.image = info.tile->image;
 						}
 						if (info.IsSingleImage()) {
 							info.u = 0;
@@ -917,13 +936,377 @@ namespace xx {
 			}
 		}
 
-		void FillTo(Map& map, std::string_view const& tmxfn) {
-			Filler(map, tmxfn);
+		void FillTo(Map& map, std::string_view const& tmxfn, FillOptions const& opts) {
+			// load file & calc rootPath
+			auto&& [d, fp] = engine.LoadFileData(tmxfn);
+			if (!d) throw std::logic_error("read file error: " + std::string(tmxfn));
+			std::string rootPath;
+			if (auto&& i = fp.find_last_of("/"); i != fp.npos) {
+				rootPath = fp.substr(0, i + 1);
+			}
+			if (IsBin(d)) {
+				FillFromBin(map, d, rootPath, opts);
+			} else {
+				Filler filler(map, d, std::move(rootPath), opts);
+			}
+		}
+
+		void CompressChunks(Map& map, int const& level) {
+			std::vector<Layer_Tile*> lts;
+			Fill(lts, map.layers);
+			for (auto& L : lts) {
+				for (auto& c : L->chunks) {
+					if (!c.zgids.len && !c.gids.empty()) {
+						ZstdCompress({ (char*)c.gids.data(), c.gids.size() * sizeof(uint32_t) }, c.zgids, level);
+					}
+					std::vector<uint32_t>().swap(c.gids);
+				}
+			}
+		}
+
+		void DecompressChunks(Map& map) {
+			std::vector<Layer_Tile*> lts;
+			Fill(lts, map.layers);
+			for (auto& L : lts) {
+				for (auto& c : L->chunks) {
+					if (!c.zgids.len) continue;
+					DecompressChunkGids(c, c.gids);
+					c.zgids.Clear(true);
+				}
+			}
+		}
+
+		void BuildObjectIndexs(Map& map) {
+			std::vector<Layer_Object*> los;
+			Fill(los, map.layers);
+			for (auto& L : los) {
+				L->index.Build(L->objects);
+			}
+		}
+
+		void DecompressChunkGids(Chunk const& chunk, std::vector<uint32_t>& out) {
+			thread_local xx::Data tmp;
+			ZstdDecompress(chunk.zgids, tmp);
+			auto n = (size_t)chunk.width * chunk.height;
+			if (tmp.len != n * sizeof(uint32_t)) {
+				throw std::logic_error(xx::ToString("DecompressChunkGids error: bad data len = ", tmp.len, ", chunk pos = ", chunk.pos.x, ", ", chunk.pos.y));
+			}
+			out.resize(n);
+			xx::Data_r dr(tmp);
+			if (dr.ReadFixedArray(out.data(), n)) {
+				throw std::logic_error("DecompressChunkGids error: read gids failed");
+			}
 		}
 
 
 		bool GidInfo::IsSingleImage() const {
-			return tile && tile->image == image;
+			return image && tile && tile->image == image;
+		}
+
+		void Tileset::FillTilesById() {
+			uint32_t n = tilecount;
+			for (auto& t : tiles) {
+				n = std::max(n, t->id + 1);
+			}
+			tilesById.clear();
+			tilesById.resize(n);
+			for (auto& t : tiles) {
+				tilesById[t->id] = t.get();
+			}
+		}
+
+		Tile* Tileset::GetTile(uint32_t id) const {
+			return id < tilesById.size() ? tilesById[id] : nullptr;
+		}
+
+		inline static bool IsEmptyBlock(std::vector<uint32_t> const& gids, uint32_t const& width, uint32_t const& height, uint32_t const& bx, uint32_t const& by) {
+			auto x0 = bx << SparseGids::blockShift, y0 = by << SparseGids::blockShift;
+			auto x1 = std::min(x0 + SparseGids::blockSize, width), y1 = std::min(y0 + SparseGids::blockSize, height);
+			for (auto y = y0; y < y1; ++y) {
+				for (auto x = x0; x < x1; ++x) {
+					if (gids[y * width + x]) return false;
+				}
+			}
+			return true;
+		}
+
+		void SparseGids::Fill(std::vector<uint32_t> const& gids, uint32_t const& width_, uint32_t const& height_) {
+			assert(gids.size() == (size_t)width_ * height_);
+			width = width_;
+			height = height_;
+			blockColumns = (width + blockMask) >> blockShift;
+			blockRows = (height + blockMask) >> blockShift;
+			blockIndexs.assign((size_t)blockColumns * blockRows, 0);
+			data.clear();
+			for (uint32_t by = 0; by < blockRows; ++by) {
+				for (uint32_t bx = 0; bx < blockColumns; ++bx) {
+					if (IsEmptyBlock(gids, width, height, bx, by)) continue;
+					auto i = data.size();
+					data.resize(i + blockArea);
+					blockIndexs[by * blockColumns + bx] = uint32_t(i / blockArea + 1);
+					auto x0 = bx << blockShift, y0 = by << blockShift;
+					auto x1 = std::min(x0 + blockSize, width), y1 = std::min(y0 + blockSize, height);
+					for (auto y = y0; y < y1; ++y) {
+						memcpy(&data[i + ((y - y0) << blockShift)], &gids[y * width + x0], (x1 - x0) * sizeof(uint32_t));
+					}
+				}
+			}
+			data.shrink_to_fit();
+		}
+
+		size_t SparseGids::GetMemorySize() const {
+			return sizeof(SparseGids) + blockIndexs.capacity() * sizeof(uint32_t) + data.capacity() * sizeof(uint32_t);
+		}
+
+		void Layer_Tile::TryMakeSparse(float const& maxDensity) {
+			if (isSparse || denseGids.empty()) return;
+			auto bc = (width + SparseGids::blockMask) >> SparseGids::blockShift;
+			auto br = (height + SparseGids::blockMask) >> SparseGids::blockShift;
+			size_t n = 0;
+			for (uint32_t by = 0; by < br; ++by) {
+				for (uint32_t bx = 0; bx < bc; ++bx) {
+					n += !IsEmptyBlock(denseGids, width, height, bx, by);
+				}
+			}
+			if (n >= maxDensity * bc * br) return;
+			sparse.Fill(denseGids, width, height);
+			isSparse = true;
+			std::vector<uint32_t>().swap(denseGids);
+		}
+
+		// https://github.com/rawrunprotected/hilbert_curves ( public domain ). x, y: 16 bits
+		inline static uint32_t Hilbert(uint32_t x, uint32_t y) {
+			uint32_t a = x ^ y;
+			uint32_t b = 0xFFFF ^ a;
+			uint32_t c = 0xFFFF ^ (x | y);
+			uint32_t d = x & (y ^ 0xFFFF);
+
+			uint32_t A = a | (b >> 1);
+			uint32_t B = (a >> 1) ^ a;
+			uint32_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+			uint32_t D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+			a = A; b = B; c = C; d = D;
+			A = ((a & (a >> 2)) ^ (b & (b >> 2)));
+			B = ((a & (b >> 2)) ^ (b & ((a ^ b) >> 2)));
+			C ^= ((a & (c >> 2)) ^ (b & (d >> 2)));
+			D ^= ((b & (c >> 2)) ^ ((a ^ b) & (d >> 2)));
+
+			a = A; b = B; c = C; d = D;
+			A = ((a & (a >> 4)) ^ (b & (b >> 4)));
+			B = ((a & (b >> 4)) ^ (b & ((a ^ b) >> 4)));
+			C ^= ((a & (c >> 4)) ^ (b & (d >> 4)));
+			D ^= ((b & (c >> 4)) ^ ((a ^ b) & (d >> 4)));
+
+			a = A; b = B; c = C; d = D;
+			C ^= ((a & (c >> 8)) ^ (b & (d >> 8)));
+			D ^= ((b & (c >> 8)) ^ ((a ^ b) & (d >> 8)));
+
+			a = C ^ (C >> 1);
+			b = D ^ (D >> 1);
+
+			uint32_t i0 = x ^ y;
+			uint32_t i1 = b | (0xFFFF ^ (i0 | a));
+
+			i0 = (i0 | (i0 << 8)) & 0x00FF00FF;
+			i0 = (i0 | (i0 << 4)) & 0x0F0F0F0F;
+			i0 = (i0 | (i0 << 2)) & 0x33333333;
+			i0 = (i0 | (i0 << 1)) & 0x55555555;
+
+			i1 = (i1 | (i1 << 8)) & 0x00FF00FF;
+			i1 = (i1 | (i1 << 4)) & 0x0F0F0F0F;
+			i1 = (i1 | (i1 << 2)) & 0x33333333;
+			i1 = (i1 | (i1 << 1)) & 0x55555555;
+
+			return (i1 << 1) | i0;
+		}
+
+		std::array<float, 4> ObjectIndex::CalcBox(Object const& o) {
+			double x0 = 0, y0 = 0, x1 = 0, y1 = 0;	// local box( relative to o.x, o.y )
+			switch (o.type) {
+			case ObjectTypes::Rectangle:
+			case ObjectTypes::Ellipse:
+			case ObjectTypes::Text:
+			{
+				auto&& a = (Object_Rectangle const&)o;
+				x1 = a.width;
+				y1 = a.height;
+				break;
+			}
+			case ObjectTypes::Tile:	// anchor: left bottom
+			{
+				auto&& a = (Object_Tile const&)o;
+				x1 = a.width;
+				y0 = -(double)a.height;
+				break;
+			}
+			case ObjectTypes::Polygon:
+			{
+				auto&& ps = ((Object_Polygon const&)o).points;
+				if (!ps.empty()) {
+					x0 = x1 = ps[0].x;
+					y0 = y1 = ps[0].y;
+					for (auto& p : ps) {
+						x0 = std::min<double>(x0, p.x);
+						x1 = std::max<double>(x1, p.x);
+						y0 = std::min<double>(y0, p.y);
+						y1 = std::max<double>(y1, p.y);
+					}
+				}
+				break;
+			}
+			default:
+				break;
+			}
+			if (o.rotation != 0) {	// degrees, clockwise around o.x, o.y
+				auto r = o.rotation * (M_PI / 180);
+				auto s = std::sin(r), c = std::cos(r);
+				std::array<double, 4> xs{ x0, x1, x1, x0 }, ys{ y0, y0, y1, y1 };
+				x0 = y0 = std::numeric_limits<double>::max();
+				x1 = y1 = std::numeric_limits<double>::lowest();
+				for (int i = 0; i < 4; ++i) {
+					auto x = xs[i] * c - ys[i] * s;
+					auto y = xs[i] * s + ys[i] * c;
+					x0 = std::min(x0, x);
+					x1 = std::max(x1, x);
+					y0 = std::min(y0, y);
+					y1 = std::max(y1, y);
+				}
+			}
+			return { float(o.x + x0), float(o.y + y0), float(o.x + x1), float(o.y + y1) };
+		}
+
+		void ObjectIndex::Clear() {
+			boxes.clear();
+			indexs.clear();
+			levelBounds.clear();
+			objects.clear();
+		}
+
+		void ObjectIndex::Build(std::vector<xx::Shared<Object>> const& os) {
+			Clear();
+			auto numItems = (uint32_t)os.size();
+			if (!numItems) return;
+
+			// calc levels
+			uint32_t n = numItems, numNodes = numItems;
+			levelBounds.push_back(n);
+			do {
+				n = (n + nodeSize - 1) / nodeSize;
+				numNodes += n;
+				levelBounds.push_back(numNodes);
+			} while (n != 1);
+
+			// calc leaves's box & sort by hilbert value of center
+			std::vector<std::array<float, 4>> bs(numItems);
+			float minX = std::numeric_limits<float>::max(), minY = minX;
+			float maxX = std::numeric_limits<float>::lowest(), maxY = maxX;
+			for (uint32_t i = 0; i < numItems; ++i) {
+				auto& b = bs[i] = CalcBox(*os[i]);
+				minX = std::min(minX, b[0]);
+				minY = std::min(minY, b[1]);
+				maxX = std::max(maxX, b[2]);
+				maxY = std::max(maxY, b[3]);
+			}
+			auto w = maxX - minX, h = maxY - minY;
+			std::vector<std::pair<uint32_t, uint32_t>> hs(numItems);	// hilbert value, index
+			for (uint32_t i = 0; i < numItems; ++i) {
+				auto& b = bs[i];
+				auto hx = w > 0 ? uint32_t(0xFFFF * ((b[0] + b[2]) / 2 - minX) / w) : 0;
+				auto hy = h > 0 ? uint32_t(0xFFFF * ((b[1] + b[3]) / 2 - minY) / h) : 0;
+				hs[i] = { Hilbert(hx, hy), i };
+			}
+			std::sort(hs.begin(), hs.end());
+
+			boxes.resize(numNodes);
+			indexs.resize(numNodes);
+			objects.resize(numItems);
+			for (uint32_t i = 0; i < numItems; ++i) {
+				auto idx = hs[i].second;
+				boxes[i] = bs[idx];
+				indexs[i] = i;
+				objects[i] = os[idx].pointer;
+			}
+
+			// fill upper levels
+			uint32_t pos = 0;
+			for (size_t L = 0; L + 1 < levelBounds.size(); ++L) {
+				auto end = levelBounds[L];
+				auto nodeIndex = end;
+				while (pos < end) {
+					auto first = pos;
+					auto b = boxes[pos];
+					for (uint32_t e = std::min(pos + nodeSize, end); pos < e; ++pos) {
+						auto& c = boxes[pos];
+						b[0] = std::min(b[0], c[0]);
+						b[1] = std::min(b[1], c[1]);
+						b[2] = std::max(b[2], c[2]);
+						b[3] = std::max(b[3], c[3]);
+					}
+					boxes[nodeIndex] = b;
+					indexs[nodeIndex] = first;
+					++nodeIndex;
+				}
+			}
+		}
+
+		void Properties::BuildIndex() {
+			index.resize(size());
+			for (uint32_t i = 0, e = (uint32_t)size(); i < e; ++i) {
+				auto&& p = (*this)[i];
+				p.nameHash = std::hash<std::string_view>{}(p.name);
+				index[i] = { p.nameHash, i };
+			}
+			std::sort(index.begin(), index.end());
+		}
+
+		Property& Properties::Add(std::string name, PropertyTypes const& type) {
+			bool indexed = index.size() == size();
+			auto&& p = emplace_back();
+			p.type = type;
+			p.name = std::move(name);
+			p.nameHash = std::hash<std::string_view>{}(p.name);
+			if (indexed) {
+				std::pair<size_t, uint32_t> k{ p.nameHash, (uint32_t)(size() - 1) };
+				index.insert(std::upper_bound(index.begin(), index.end(), k), k);
+			}
+			return p;
+		}
+
+		void Properties::Rename(Property& p, std::string name) {
+			auto i = (uint32_t)(&p - data());
+			auto h = std::hash<std::string_view>{}(name);
+			if (index.size() == size()) {
+				if (auto iter = std::find(index.begin(), index.end(), std::pair<size_t, uint32_t>{ p.nameHash, i }); iter != index.end()) {
+					index.erase(iter);
+				}
+				std::pair<size_t, uint32_t> k{ h, i };
+				index.insert(std::upper_bound(index.begin(), index.end(), k), k);
+			}
+			p.name = std::move(name);
+			p.nameHash = h;
+		}
+
+		template<typename PS>
+		inline static auto FindPropertyCore(PS& ps, std::string_view const& name) -> decltype(&ps[0]) {
+			if (ps.index.size() != ps.size()) {	// stale index: nameHash may be stale too
+				for (auto& p : ps) {
+					if (p.name == name) return &p;
+				}
+				return nullptr;
+			}
+			auto h = std::hash<std::string_view>{}(name);
+			auto iter = std::lower_bound(ps.index.begin(), ps.index.end(), h, [](auto const& a, size_t const& b) { return a.first < b; });
+			for (; iter != ps.index.end() && iter->first == h; ++iter) {
+				if (auto&& p = ps[iter->second]; p.name == name) return &p;
+			}
+			return nullptr;
+		}
+		Property* FindProperty(Properties& ps, std::string_view const& name) {
+			return FindPropertyCore(ps, name);
+		}
+		Property const* FindProperty(Properties const& ps, std::string_view const& name) {
+			return FindPropertyCore(ps, name);
 		}
 	}
 
@@ -23,9 +23,20 @@ namespace xx {
 		struct Property {
 			PropertyTypes type = PropertyTypes::MAX_VALUE_UNKNOWN;
 			std::string name;
+			size_t nameHash = 0;	// std::hash( name ). for fast FindProperty
 			std::variant<bool, RGBA8, int64_t, double, std::unique_ptr<std::string>, Object*> value;
 		};
 
+		// property list + index sorted by ( nameHash, position ) for FindProperty's binary search
+		// loaders build the index. Add / Rename keep nameHash & index up to date
+		// other direct edits ( erase, assign name ): call BuildIndex ( it refreshes nameHash too )
+		struct Properties : std::vector<Property> {
+			std::vector<std::pair<size_t, uint32_t>> index;
+			void BuildIndex();
+			Property& Add(std::string name, PropertyTypes const& type = PropertyTypes::String);
+			void Rename(Property& p, std::string name);
+		};
+
 		/**********************************************************************************/
 
 		enum class ObjectTypes : uint8_t {
@@ -47,7 +58,7 @@ namespace xx {
 			double y = 0;
 			double rotation = false;
 			bool visible = true;
-			std::vector<Property> properties;	// <properties> <property <property
+			Properties properties;	// <properties> <property <property
 		};
 
 		struct Object_Point : Object {};
@@ -129,19 +140,83 @@ namespace xx {
 			double horizontalOffset = 0;	// offsetx
 			double verticalOffset = 0;	// offsety
 			Pointf parallaxFactor = { 1, 1 };	// parallaxx, parallaxy
-			std::vector<Property> properties;	// <properties> <property <property
+			Properties properties;	// <properties> <property <property
 		};
 
 		struct Chunk {
-			std::vector<uint32_t> gids;
+			std::vector<uint32_t> gids;	// empty when streaming & not loaded
 			uint32_t height = 0;
 			uint32_t width = 0;
 			Pointi pos;	// x, y
+			xx::Data zgids;	// streaming only: zstd compressed gids( little endian uint32 ). decode by ChunkStreamer
+		};
+
+		// sparse storage for low density tile layer: split to blockSize * blockSize blocks, empty block not stored. benchmark: bench/tmx_sparse_layer.cpp
+		struct SparseGids {
+			inline static constexpr uint32_t blockShift = 4, blockSize = 1u << blockShift, blockMask = blockSize - 1, blockArea = blockSize * blockSize;
+			uint32_t width = 0, height = 0, blockColumns = 0, blockRows = 0;
+			std::vector<uint32_t> blockIndexs;	// [ by * blockColumns + bx ] = data's block index + 1. 0: empty block
+			std::vector<uint32_t> data;	// non empty blocks's gids
+
+			void Fill(std::vector<uint32_t> const& gids, uint32_t const& width_, uint32_t const& height_);
+
+			// return nullptr if block is empty
+			XX_FORCE_INLINE uint32_t const* GetBlock(uint32_t const& bx, uint32_t const& by) const {
+				auto i = blockIndexs[by * blockColumns + bx];
+				return i ? &data[(i - 1) * blockArea] : nullptr;
+			}
+
+			XX_FORCE_INLINE uint32_t Get(uint32_t const& x, uint32_t const& y) const {
+				assert(x < width && y < height);
+				auto b = GetBlock(x >> blockShift, y >> blockShift);
+				return b ? b[((y & blockMask) << blockShift) + (x & blockMask)] : 0;
+			}
+
+			// f( x, gid ) for every non zero gid in row y, x in [ xFrom, xTo ). empty blocks are skipped
+			template<typename F>
+			void ForeachInRow(uint32_t const& y, uint32_t const& xFrom, uint32_t const& xTo, F&& f) const {
+				auto rowOffset = (y & blockMask) << blockShift;
+				for (uint32_t bx = xFrom >> blockShift, bxTo = (xTo + blockMask) >> blockShift; bx < bxTo; ++bx) {
+					auto b = GetBlock(bx, y >> blockShift);
+					if (!b) continue;
+					b += rowOffset;
+					auto x0 = bx << blockShift;
+					for (auto x = std::max(x0, xFrom), e = std::min(x0 + blockSize, xTo); x < e; ++x) {
+						if (auto gid = b[x - x0]) f(x, gid);
+					}
+				}
+			}
+
+			size_t GetMemorySize() const;	// bytes
 		};
 
 		struct Layer_Tile : Layer {
+			uint32_t width = 0, height = 0;	// == map's when map.infinite == false
 			std::vector<Chunk> chunks;	// when map.infinite == true
-			std::vector<uint32_t> gids;	// when map.infinite == false
+			std::vector<uint32_t> denseGids;	// when map.infinite == false && !isSparse. read cells by GetGid / ForeachInRow
+			SparseGids sparse;	// when map.infinite == false && isSparse
+			bool isSparse = false;
+
+			// for map.infinite == false. x < width, y < height
+			XX_FORCE_INLINE uint32_t GetGid(uint32_t const& x, uint32_t const& y) const {
+				return isSparse ? sparse.Get(x, y) : denseGids[y * width + x];
+			}
+
+			// f( x, gid ) for every non zero gid in row y, x in [ xFrom, xTo )
+			template<typename F>
+			void ForeachInRow(uint32_t const& y, uint32_t const& xFrom, uint32_t const& xTo, F&& f) const {
+				if (isSparse) {
+					sparse.ForeachInRow(y, xFrom, xTo, std::forward<F>(f));
+				} else {
+					auto row = &denseGids[y * width];
+					for (auto x = xFrom; x < xTo; ++x) {
+						if (auto gid = row[x]) f(x, gid);
+					}
+				}
+			}
+
+			// convert denseGids to sparse when non empty blocks ratio < maxDensity
+			void TryMakeSparse(float const& maxDensity);
 		};
 
 		enum class DrawOrders : uint8_t {
@@ -150,10 +225,64 @@ namespace xx {
 			MAX_VALUE_UNKNOWN
 		};
 
+		// static packed hilbert R-tree over objects's bounding box( rotation included ). query without alloc. benchmark: bench/tmx_object_index.cpp
+		struct ObjectIndex {
+			inline static constexpr uint32_t nodeSize = 16;
+			std::vector<std::array<float, 4>> boxes;	// minX, minY, maxX, maxY. leaves( sorted by hilbert value ) + every upper level's nodes
+			std::vector<uint32_t> indexs;	// leaf: objects index. node: first child's boxes index
+			std::vector<uint32_t> levelBounds;	// every level's end index in boxes
+			std::vector<Object*> objects;
+
+			void Build(std::vector<xx::Shared<Object>> const& os);
+			void Clear();
+			static std::array<float, 4> CalcBox(Object const& o);
+
+			// f( Object* ) for every object's box intersect with [ minX, maxX ] [ minY, maxY ]. f can return true to stop
+			template<typename F>
+			void Query(float const& minX, float const& minY, float const& maxX, float const& maxY, F&& f) const {
+				if (boxes.empty()) return;
+				auto numItems = (uint32_t)objects.size();
+				std::array<uint32_t, 256> stack;	// enough for nodeSize * levels( <= 8 )
+				uint32_t top = 0;
+				uint32_t nodeIndex = (uint32_t)boxes.size() - 1;
+				while (true) {
+					uint32_t levelEnd = 0;
+					for (auto& b : levelBounds) {
+						if (b > nodeIndex) {
+							levelEnd = b;
+							break;
+						}
+					}
+					for (uint32_t pos = nodeIndex, end = std::min(nodeIndex + nodeSize, levelEnd); pos < end; ++pos) {
+						auto& b = boxes[pos];
+						if (maxX < b[0] || maxY < b[1] || minX > b[2] || minY > b[3]) continue;
+						if (nodeIndex < numItems) {
+							if constexpr (std::is_same_v<bool, decltype(f(objects[0]))>) {
+								if (f(objects[indexs[pos]])) return;
+							} else {
+								f(objects[indexs[pos]]);
+							}
+						} else {
+							assert(top < stack.size());
+							stack[top++] = indexs[pos];
+						}
+					}
+					if (!top) return;
+					nodeIndex = stack[--top];
+				}
+			}
+
+			template<typename F>
+			void QueryPoint(float const& x, float const& y, F&& f) const {
+				Query(x, y, x, y, std::forward<F>(f));
+			}
+		};
+
 		struct Layer_Object : Layer {
 			std::optional<RGBA8> color;
 			DrawOrders draworder = DrawOrders::TopDown;
 			std::vector<xx::Shared<Object>> objects;
+			ObjectIndex index;	// fill when FillOptions::indexObjects. call index.Build( objects ) after modify objects
 		};
 
 		struct Layer_Group : Layer {
@@ -187,7 +316,7 @@ namespace xx {
 			xx::Shared<Image> image;	// <image ...>
 			xx::Shared<Layer_Object> collisions;	// <objectgroup> <object <object
 			std::vector<Frame> animation;	// <animation> <frame <frame
-			std::vector<Property> properties;	// <properties> <property <property
+			Properties properties;	// <properties> <property <property
 		};
 
 		struct WangTile {
@@ -201,7 +330,7 @@ namespace xx {
 			RGBA8 color = { 0, 0, 0, 255 };
 			uint32_t tile = 0;
 			double probability = 1;
-			std::vector<Property> properties;	// <properties> <property <property
+			Properties properties;	// <properties> <property <property
 		};
 
 		enum class WangSetTypes : uint8_t {
@@ -217,7 +346,7 @@ namespace xx {
 			uint32_t tile = 0;
 			std::vector<WangTile> wangTiles;	// <wangtile
 			std::vector<std::unique_ptr<WangColor>> wangColors;	// <wangcolor
-			std::vector<Property> properties;	// <properties> <property <property
+			Properties properties;	// <properties> <property <property
 		};
 
 		struct Transformations {
@@ -283,7 +412,7 @@ namespace xx {
 			uint32_t tileheight = 0;
 			uint32_t margin = 0;
 			uint32_t spacing = 0;
-			std::vector<Property> properties;	// <properties> <property <property
+			Properties properties;	// <properties> <property <property
 
 			std::string version;
 			std::string tiledversion;
@@ -291,6 +420,11 @@ namespace xx {
 
 			std::vector<std::unique_ptr<WangSet>> wangSets;	// <wangsets>
 			std::vector<std::unique_ptr<Tile>> tiles;	// <tile <tile <tile
+
+			// ext
+			std::vector<Tile*> tilesById;	// index: tile id. maybe nullptr
+			void FillTilesById();	// call after tiles filled
+			Tile* GetTile(uint32_t id) const;	// return nullptr if not found
 		};
 
 		/**********************************************************************************/
@@ -334,10 +468,10 @@ namespace xx {
 		struct GidInfo {
 			Tileset* tileset;
 			Tile* tile;	// maybe nullptr
-			Image* image;
+			Image* image;	// nullptr when tileset and tile both have no image
 			uint16_t u, v, w, h;	// uv box
 
-			bool IsSingleImage() const;	// return image == tile->image
+			bool IsSingleImage() const;	// return image && image == tile->image
 		};
 
 		struct TileLayerFormat {
@@ -363,7 +497,7 @@ namespace xx {
 			RenderOrders renderOrder = RenderOrders::RightDown;	// renderorder
 			int32_t compressionLevel = -1;	// compressionlevel
 			std::optional<RGBA8> backgroundColor;	// backgroundcolor
-			std::vector<Property> properties;	// <properties> <property <property
+			Properties properties;	// <properties> <property <property
 
 			std::string version;
 			std::string tiledVersion;	// tiledversion
@@ -379,7 +513,43 @@ namespace xx {
 
 		/**********************************************************************************/
 
-		void FillTo(Map& map, std::string_view const& tmxfn);
+		// search property by name( binary search index by hash, then compare name ). return nullptr if not found. benchmark: bench/tmx_tileset_props.cpp
+		// index size != properties size ( not built yet ): linear search
+		Property* FindProperty(Properties& ps, std::string_view const& name);
+		Property const* FindProperty(Properties const& ps, std::string_view const& name);
+
+		struct FillOptions {
+			bool streamChunks = false;	// infinite map only: keep chunk's gids zstd compressed( Chunk.zgids ), decode by ChunkStreamer
+			int compressionLevel = 3;	// for compress non zstd chunk data when streamChunks
+			float sparseDensity = 0.5f;	// finite map only: tile layer use SparseGids when non empty blocks ratio < this. 0: disable
+			bool indexObjects = false;	// build Layer_Object.index for every object layer ( not include tile's collisions )
+			bool loadTextures = true;	// false: Image::texture stay empty ( no gl context: compile .tmb, tests, benchmarks )
+		};
+
+		// fill by .tmx or precompiled .tmb ( auto detect by binMagic )
+		void FillTo(Map& map, std::string_view const& tmxfn, FillOptions const& opts = {});
+
+		// move every chunk's gids into zgids ( skip compressed ). DecompressChunks do the reverse
+		void CompressChunks(Map& map, int const& level = 3);
+		void DecompressChunks(Map& map);
+
+		// build every object layer's index
+		void BuildObjectIndexs(Map& map);
+
+		// decode chunk.zgids to out( size == width * height ). thread safe
+		void DecompressChunkGids(Chunk const& chunk, std::vector<uint32_t>& out);
+
+		/**********************************************************************************/
+		// precompiled binary map: fully resolved Map( include gidInfos, image refs ). .tmx is still the authoring format
+
+		inline static constexpr std::array<uint8_t, 4> binMagic{ 't', 'm', 'b', 4 };
+		bool IsBin(std::string_view const& buf);
+
+		// offline compile: FillTo( .tmx ) + WriteTo + WriteAllBytes( .tmb ). benchmark: bench/tmx_load.cpp
+		void WriteTo(xx::Data& d, Map const& map);
+
+		// fill by .tmb file's content. image textures will be load from rootPath + image->source
+		void FillFromBin(Map& map, xx::Data_r dr, std::string_view const& rootPath, FillOptions const& opts = {});
 	};
 
 }
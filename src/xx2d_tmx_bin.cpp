@@ -0,0 +1,685 @@
+﻿#include "xx2d.h"
+
+namespace xx {
+
+	namespace TMX {
+
+		// .tmb layout: binMagic + map fields + images + tilesets + layers + gidInfos
+		// pointers are stored as index + 1 ( 0 == nullptr ). object refs use the object's ordinal in write order
+
+		static_assert(sizeof(Pointi) == sizeof(int32_t) * 2);
+
+		template<typename T>
+		inline static void WriteBinArray(xx::Data& d, std::vector<T> const& vs) {
+			d.WriteVarInteger(vs.size());
+			if (vs.empty()) return;
+			d.WriteFixedArray(vs.data(), vs.size());
+		}
+
+		template<typename T>
+		inline static int ReadBinArray(xx::Data_r& dr, std::vector<T>& vs) {
+			size_t siz;
+			if (int r = dr.ReadVarInteger(siz)) return r;
+			if (siz > dr.LeftLen() / sizeof(T)) return __LINE__;
+			vs.resize(siz);
+			if (!siz) return 0;
+			return dr.ReadFixedArray(vs.data(), siz);
+		}
+
+		/**************************************************************************************************/
+
+		struct BinWriter {
+			xx::Data& d;
+			Map const& map;
+			std::unordered_map<Image const*, uint32_t> images;
+			std::unordered_map<Tileset const*, uint32_t> tilesets;
+			std::unordered_map<Tile const*, uint32_t> tiles;	// index in tileset->tiles
+			std::unordered_map<Object const*, uint32_t> objs;	// ordinal
+
+			BinWriter(xx::Data& d, Map const& map) : d(d), map(map) {}
+
+			// make ordinals by the same order as Write
+			void Collect(Layer_Object const& L) {
+				for (auto&& o : L.objects) {
+					objs.emplace(o.pointer, (uint32_t)objs.size() + 1);
+				}
+			}
+			void Collect(std::vector<xx::Shared<Layer>> const& ls) {
+				for (auto&& L : ls) {
+					if (L->type == LayerTypes::ObjectLayer) {
+						Collect((Layer_Object const&)*L);
+					} else if (L->type == LayerTypes::GroupLayer) {
+						Collect(((Layer_Group const&)*L).layers);
+					}
+				}
+			}
+
+			template<typename T>
+			uint32_t IndexOf(std::unordered_map<T const*, uint32_t> const& m, T const* p) {
+				if (!p) return 0;
+				if (auto&& iter = m.find(p); iter != m.end()) return iter->second;
+				throw std::logic_error("TMX WriteTo error: can't find pointer's index");
+			}
+
+			void Write(RGBA8 const& c) {
+				d.Write(c.r, c.g, c.b, c.a);
+			}
+			void Write(std::optional<RGBA8> const& c) {
+				d.WriteFixed((uint8_t)c.has_value());
+				if (c.has_value()) Write(*c);
+			}
+
+			void Write(Properties const& ps) {
+				d.WriteVarInteger(ps.size());
+				for (auto&& p : ps) {
+					d.Write(p.type, p.name);
+					switch (p.type) {
+					case PropertyTypes::Bool:
+						d.Write(std::get<bool>(p.value));
+						break;
+					case PropertyTypes::Color:
+						Write(std::get<RGBA8>(p.value));
+						break;
+					case PropertyTypes::Float:
+						d.Write(std::get<double>(p.value));
+						break;
+					case PropertyTypes::Int:
+						d.Write(std::get<int64_t>(p.value));
+						break;
+					case PropertyTypes::Object:
+						d.Write(IndexOf(objs, std::get<Object*>(p.value)));
+						break;
+					case PropertyTypes::File:
+					case PropertyTypes::String:
+						d.Write(*std::get<std::unique_ptr<std::string>>(p.value));
+						break;
+					default:
+						throw std::logic_error("TMX WriteTo error: unhandled property type: " + std::to_string((int)p.type));
+					}
+				}
+			}
+
+			void Write(Object const& o) {
+				d.Write(o.type, o.id, o.name, o.class_, o.x, o.y, o.rotation, o.visible);
+				Write(o.properties);
+				switch (o.type) {
+				case ObjectTypes::Point:
+					break;
+				case ObjectTypes::Ellipse:
+				case ObjectTypes::Rectangle:
+				{
+					auto&& a = (Object_Rectangle const&)o;
+					d.Write(a.width, a.height);
+					break;
+				}
+				case ObjectTypes::Polygon:
+				{
+					auto&& ps = ((Object_Polygon const&)o).points;
+					d.WriteVarInteger(ps.size());
+					if (!ps.empty()) d.WriteFixedArray((int32_t const*)ps.data(), ps.size() * 2);
+					break;
+				}
+				case ObjectTypes::Tile:
+				{
+					auto&& a = (Object_Tile const&)o;
+					d.Write(a.width, a.height, a.gid, a.flippingHorizontal, a.flippingVertical);
+					break;
+				}
+				case ObjectTypes::Text:
+				{
+					auto&& a = (Object_Text const&)o;
+					d.Write(a.width, a.height, a.fontfamily, a.pixelsize);
+					Write(a.color);
+					d.Write(a.wrap, a.bold, a.italic, a.underline, a.strikeout, a.kerning, a.halign, a.valign, a.text);
+					break;
+				}
+				default:
+					throw std::logic_error("TMX WriteTo error: unhandled object type: " + std::to_string((int)o.type));
+				}
+			}
+
+			void Write(Layer_Object const& L) {
+				Write(L.color);
+				d.Write(L.draworder);
+				d.WriteVarInteger(L.objects.size());
+				for (auto&& o : L.objects) {
+					Write(*o);
+				}
+			}
+
+			// fields of Layer ( include type )
+			void WriteLayerBase(Layer const& L) {
+				d.Write(L.type, L.id, L.name, L.class_, L.visible, L.locked, L.opacity);
+				Write(L.tintColor);
+				d.Write(L.horizontalOffset, L.verticalOffset, L.parallaxFactor.x, L.parallaxFactor.y);
+				Write(L.properties);
+			}
+
+			void Write(std::vector<xx::Shared<Layer>> const& ls) {
+				d.WriteVarInteger(ls.size());
+				for (auto&& L : ls) {
+					WriteLayerBase(*L);
+					switch (L->type) {
+					case LayerTypes::TileLayer:
+					{
+						auto&& o = (Layer_Tile const&)*L;
+						d.Write(o.width, o.height);
+						d.WriteVarInteger(o.chunks.size());
+						for (auto&& c : o.chunks) {
+							d.Write(c.height, c.width, c.pos.x, c.pos.y);
+							WriteBinArray(d, c.gids);
+							d.Write(c.zgids);
+						}
+						d.Write(o.isSparse);
+						if (o.isSparse) {
+							WriteBinArray(d, o.sparse.blockIndexs);
+							WriteBinArray(d, o.sparse.data);
+						} else {
+							WriteBinArray(d, o.denseGids);
+						}
+						break;
+					}
+					case LayerTypes::ObjectLayer:
+						Write((Layer_Object const&)*L);
+						break;
+					case LayerTypes::ImageLayer:
+					{
+						auto&& o = (Layer_Image const&)*L;
+						d.Write(IndexOf(images, o.image.pointer), o.repeatX, o.repeatY);
+						break;
+					}
+					case LayerTypes::GroupLayer:
+						Write(((Layer_Group const&)*L).layers);
+						break;
+					default:
+						throw std::logic_error("TMX WriteTo error: unhandled layer type: " + std::to_string((int)L->type));
+					}
+				}
+			}
+
+			void Write(Tileset const& ts) {
+				d.Write(ts.firstgid, ts.source, ts.name, ts.class_, ts.objectAlignment, ts.drawingOffset.x, ts.drawingOffset.y
+					, ts.tileRenderSize, ts.fillMode);
+				Write(ts.backgroundColor);
+				auto&& t = ts.allowedTransformations;
+				d.Write(ts.orientation, ts.gridWidth, ts.gridHeight, ts.columns
+					, t.flipHorizontally, t.flipVertically, t.rotate, t.preferUntransformedTiles
+					, IndexOf(images, ts.image.pointer), ts.tilewidth, ts.tileheight, ts.margin, ts.spacing);
+				Write(ts.properties);
+				d.Write(ts.version, ts.tiledversion, ts.tilecount);
+
+				d.WriteVarInteger(ts.wangSets.size());
+				for (auto&& w : ts.wangSets) {
+					d.Write(w->name, w->type, w->tile);
+					Write(w->properties);
+					d.WriteVarInteger(w->wangColors.size());
+					for (auto&& c : w->wangColors) {
+						d.Write(c->name);
+						Write(c->color);
+						d.Write(c->tile, c->probability);
+						Write(c->properties);
+					}
+					d.WriteVarInteger(w->wangTiles.size());
+					for (auto&& wt : w->wangTiles) {
+						d.Write(wt.tileId, wt.gid);
+						WriteBinArray(d, wt.wangIds);
+					}
+				}
+
+				d.WriteVarInteger(ts.tiles.size());
+				for (auto&& o : ts.tiles) {
+					d.Write(o->id, o->class_, IndexOf(images, o->image.pointer));
+					Write(o->properties);
+					d.WriteFixed((uint8_t)!!o->collisions);
+					if (o->collisions) {
+						WriteLayerBase(*o->collisions);
+						Write(*o->collisions);
+					}
+					d.WriteVarInteger(o->animation.size());
+					for (auto&& f : o->animation) {
+						d.Write(f.tileId, f.gid, f.duration);
+					}
+				}
+			}
+
+			void Write() {
+				for (uint32_t i = 0, e = (uint32_t)map.images.size(); i < e; ++i) {
+					images.emplace(map.images[i].pointer, i + 1);
+				}
+				for (uint32_t i = 0, e = (uint32_t)map.tilesets.size(); i < e; ++i) {
+					auto&& ts = map.tilesets[i];
+					tilesets.emplace(ts.pointer, i + 1);
+					for (uint32_t j = 0, je = (uint32_t)ts->tiles.size(); j < je; ++j) {
+						auto&& t = ts->tiles[j];
+						tiles.emplace(t.get(), j + 1);
+						if (t->collisions) {
+							Collect(*t->collisions);
+						}
+					}
+				}
+				Collect(map.layers);
+
+				d.WriteBuf(binMagic.data(), binMagic.size());
+				d.Write(map.class_, map.orientation, map.width, map.height, map.tileWidth, map.tileHeight, map.infinite
+					, map.tileSideLength, map.staggeraxis, map.staggerindex, map.parallaxOrigin.x, map.parallaxOrigin.y
+					, map.tileLayerFormat.encoding, map.tileLayerFormat.compression, map.outputChunkWidth, map.outputChunkHeight
+					, map.renderOrder, map.compressionLevel);
+				Write(map.backgroundColor);
+				Write(map.properties);
+				d.Write(map.version, map.tiledVersion, map.nextLayerId, map.nextObjectId);
+
+				d.WriteVarInteger(map.images.size());
+				for (auto&& img : map.images) {
+					d.Write(img->source, img->width, img->height);
+					Write(img->transparentColor);
+				}
+
+				d.WriteVarInteger(map.tilesets.size());
+				for (auto&& ts : map.tilesets) {
+					Write(*ts);
+				}
+
+				Write(map.layers);
+
+				d.WriteVarInteger(map.gidInfos.size());
+				for (auto&& o : map.gidInfos) {
+					d.Write(IndexOf(tilesets, o.tileset), o.tileset ? IndexOf(tiles, o.tile) : 0u, IndexOf(images, o.image)
+						, o.u, o.v, o.w, o.h);
+				}
+			}
+		};
+
+		/**************************************************************************************************/
+
+		struct BinReader {
+			xx::Data_r dr;
+			Map& map;
+			std::string_view rootPath;
+			bool loadTextures;
+			std::vector<Object*> objs;	// index: ordinal - 1
+			std::vector<std::pair<Properties*, size_t>> objProps;	// store properties[ idx ] need replace ordinal to obj
+
+			BinReader(Map& map, xx::Data_r dr, std::string_view const& rootPath, bool const& loadTextures) : dr(dr), map(map), rootPath(rootPath), loadTextures(loadTextures) {}
+
+			template<typename...TS>
+			void Read(TS&...vs) {
+				if (int r = dr.Read(vs...)) {
+					throw std::logic_error(xx::ToString("TMX FillFromBin read error. r = ", r, ", offset = ", dr.offset));
+				}
+			}
+
+			template<typename T>
+			void ReadArray(std::vector<T>& vs) {
+				if (int r = ReadBinArray(dr, vs)) {
+					throw std::logic_error(xx::ToString("TMX FillFromBin read array error. r = ", r, ", offset = ", dr.offset));
+				}
+			}
+
+			size_t ReadCount() {
+				size_t siz;
+				Read(siz);
+				if (siz > dr.LeftLen()) {	// every item takes 1 byte at least
+					throw std::logic_error(xx::ToString("TMX FillFromBin read error: bad count = ", siz, ", offset = ", dr.offset));
+				}
+				return siz;
+			}
+
+			template<typename T>
+			T* ReadPointer(std::vector<xx::Shared<T>> const& vs) {
+				uint32_t i;
+				Read(i);
+				if (!i) return nullptr;
+				if (i > vs.size()) throw std::logic_error(xx::ToString("TMX FillFromBin read error: bad index = ", i, ", offset = ", dr.offset));
+				return vs[i - 1].pointer;
+			}
+
+			void ReadTo(RGBA8& c) {
+				Read(c.r, c.g, c.b, c.a);
+			}
+			void ReadTo(std::optional<RGBA8>& c) {
+				uint8_t has;
+				Read(has);
+				if (has) ReadTo(c.emplace());
+				else c.reset();
+			}
+
+			void ReadTo(Properties& ps) {
+				ps.resize(ReadCount());
+				for (size_t i = 0, e = ps.size(); i < e; ++i) {
+					auto&& p = ps[i];
+					Read(p.type, p.name);
+					p.nameHash = std::hash<std::string_view>{}(p.name);
+					switch (p.type) {
+					case PropertyTypes::Bool:
+						Read(p.value.emplace<bool>());
+						break;
+					case PropertyTypes::Color:
+						ReadTo(p.value.emplace<RGBA8>());
+						break;
+					case PropertyTypes::Float:
+						Read(p.value.emplace<double>());
+						break;
+					case PropertyTypes::Int:
+						Read(p.value.emplace<int64_t>());
+						break;
+					case PropertyTypes::Object:
+					{
+						uint32_t ordinal;
+						Read(ordinal);
+						p.value = (int64_t)ordinal;	// convert to Object* after all objects filled
+						objProps.emplace_back(&ps, i);
+						break;
+					}
+					case PropertyTypes::File:
+					case PropertyTypes::String:
+						Read(*p.value.emplace<std::unique_ptr<std::string>>(std::make_unique<std::string>()));
+						break;
+					default:
+						throw std::logic_error("TMX FillFromBin error: unhandled property type: " + std::to_string((int)p.type));
+					}
+				}
+				ps.BuildIndex();
+			}
+
+			void ReadTo(xx::Shared<Object>& out) {
+				ObjectTypes type;
+				Read(type);
+				switch (type) {
+				case ObjectTypes::Point:
+					out = xx::Make<Object_Point>();
+					break;
+				case ObjectTypes::Ellipse:
+					out = xx::Make<Object_Ellipse>();
+					break;
+				case ObjectTypes::Rectangle:
+					out = xx::Make<Object_Rectangle>();
+					break;
+				case ObjectTypes::Polygon:
+					out = xx::Make<Object_Polygon>();
+					break;
+				case ObjectTypes::Tile:
+					out = xx::Make<Object_Tile>();
+					break;
+				case ObjectTypes::Text:
+					out = xx::Make<Object_Text>();
+					break;
+				default:
+					throw std::logic_error("TMX FillFromBin error: unhandled object type: " + std::to_string((int)type));
+				}
+				auto&& o = *out;
+				o.type = type;
+				objs.push_back(&o);
+				Read(o.id, o.name, o.class_, o.x, o.y, o.rotation, o.visible);
+				ReadTo(o.properties);
+				switch (type) {
+				case ObjectTypes::Ellipse:
+				case ObjectTypes::Rectangle:
+				{
+					auto&& a = (Object_Rectangle&)o;
+					Read(a.width, a.height);
+					break;
+				}
+				case ObjectTypes::Polygon:
+				{
+					auto&& ps = ((Object_Polygon&)o).points;
+					size_t siz;
+					Read(siz);
+					if (siz > dr.LeftLen() / sizeof(Pointi)) throw std::logic_error("TMX FillFromBin read error: bad points count");
+					ps.resize(siz);
+					if (siz) {
+						if (int r = dr.ReadFixedArray((int32_t*)ps.data(), siz * 2)) throw std::logic_error("TMX FillFromBin read points error. r = " + std::to_string(r));
+					}
+					break;
+				}
+				case ObjectTypes::Tile:
+				{
+					auto&& a = (Object_Tile&)o;
+					Read(a.width, a.height, a.gid, a.flippingHorizontal, a.flippingVertical);
+					break;
+				}
+				case ObjectTypes::Text:
+				{
+					auto&& a = (Object_Text&)o;
+					Read(a.width, a.height, a.fontfamily, a.pixelsize);
+					ReadTo(a.color);
+					Read(a.wrap, a.bold, a.italic, a.underline, a.strikeout, a.kerning, a.halign, a.valign, a.text);
+					break;
+				}
+				default:
+					break;
+				}
+			}
+
+			void ReadTo(Layer_Object& L) {
+				L.type = LayerTypes::ObjectLayer;
+				ReadTo(L.color);
+				Read(L.draworder);
+				L.objects.resize(ReadCount());
+				for (auto&& o : L.objects) {
+					ReadTo(o);
+				}
+			}
+
+			// fields of Layer after type
+			void ReadLayerBase(Layer& L) {
+				Read(L.id, L.name, L.class_, L.visible, L.locked, L.opacity);
+				ReadTo(L.tintColor);
+				Read(L.horizontalOffset, L.verticalOffset, L.parallaxFactor.x, L.parallaxFactor.y);
+				ReadTo(L.properties);
+			}
+
+			void ReadTo(std::vector<xx::Shared<Layer>>& ls) {
+				ls.resize(ReadCount());
+				for (auto&& L : ls) {
+					LayerTypes type;
+					Read(type);
+					switch (type) {
+					case LayerTypes::TileLayer:
+						L = xx::Make<Layer_Tile>();
+						break;
+					case LayerTypes::ObjectLayer:
+						L = xx::Make<Layer_Object>();
+						break;
+					case LayerTypes::ImageLayer:
+						L = xx::Make<Layer_Image>();
+						break;
+					case LayerTypes::GroupLayer:
+						L = xx::Make<Layer_Group>();
+						break;
+					default:
+						throw std::logic_error("TMX FillFromBin error: unhandled layer type: " + std::to_string((int)type));
+					}
+					L->type = type;
+					ReadLayerBase(*L);
+					switch (type) {
+					case LayerTypes::TileLayer:
+					{
+						auto&& o = (Layer_Tile&)*L;
+						Read(o.width, o.height);
+						o.chunks.resize(ReadCount());
+						for (auto&& c : o.chunks) {
+							Read(c.height, c.width, c.pos.x, c.pos.y);
+							ReadArray(c.gids);
+							Read(c.zgids);
+						}
+						Read(o.isSparse);
+						if (o.isSparse) {
+							auto&& s = o.sparse;
+							s.width = o.width;
+							s.height = o.height;
+							s.blockColumns = (s.width + SparseGids::blockMask) >> SparseGids::blockShift;
+							s.blockRows = (s.height + SparseGids::blockMask) >> SparseGids::blockShift;
+							ReadArray(s.blockIndexs);
+							ReadArray(s.data);
+							if (s.blockIndexs.size() != (size_t)s.blockColumns * s.blockRows) throw std::logic_error("TMX FillFromBin error: bad sparse block indexs count");
+							for (auto& i : s.blockIndexs) {
+								if (i > s.data.size() / SparseGids::blockArea) throw std::logic_error("TMX FillFromBin error: bad sparse block index");
+							}
+						} else {
+							ReadArray(o.denseGids);
+						}
+						break;
+					}
+					case LayerTypes::ObjectLayer:
+						ReadTo((Layer_Object&)*L);
+						break;
+					case LayerTypes::ImageLayer:
+					{
+						auto&& o = (Layer_Image&)*L;
+						o.image = ReadPointer(map.images);
+						Read(o.repeatX, o.repeatY);
+						break;
+					}
+					case LayerTypes::GroupLayer:
+						ReadTo(((Layer_Group&)*L).layers);
+						break;
+					default:
+						break;
+					}
+				}
+			}
+
+			void ReadTo(Tileset& ts) {
+				Read(ts.firstgid, ts.source, ts.name, ts.class_, ts.objectAlignment, ts.drawingOffset.x, ts.drawingOffset.y
+					, ts.tileRenderSize, ts.fillMode);
+				ReadTo(ts.backgroundColor);
+				auto&& t = ts.allowedTransformations;
+				Read(ts.orientation, ts.gridWidth, ts.gridHeight, ts.columns
+					, t.flipHorizontally, t.flipVertically, t.rotate, t.preferUntransformedTiles);
+				ts.image = ReadPointer(map.images);
+				Read(ts.tilewidth, ts.tileheight, ts.margin, ts.spacing);
+				ReadTo(ts.properties);
+				Read(ts.version, ts.tiledversion, ts.tilecount);
+
+				ts.wangSets.resize(ReadCount());
+				for (auto&& w : ts.wangSets) {
+					w = std::make_unique<WangSet>();
+					Read(w->name, w->type, w->tile);
+					ReadTo(w->properties);
+					w->wangColors.resize(ReadCount());
+					for (auto&& c : w->wangColors) {
+						c = std::make_unique<WangColor>();
+						Read(c->name);
+						ReadTo(c->color);
+						Read(c->tile, c->probability);
+						ReadTo(c->properties);
+					}
+					w->wangTiles.resize(ReadCount());
+					for (auto&& wt : w->wangTiles) {
+						Read(wt.tileId, wt.gid);
+						ReadArray(wt.wangIds);
+					}
+				}
+
+				ts.tiles.resize(ReadCount());
+				for (auto&& o : ts.tiles) {
+					o = std::make_unique<Tile>();
+					Read(o->id, o->class_);
+					o->image = ReadPointer(map.images);
+					ReadTo(o->properties);
+					uint8_t hasCollisions;
+					Read(hasCollisions);
+					if (hasCollisions) {
+						auto&& c = *o->collisions.Emplace();
+						LayerTypes type;
+						Read(type);
+						if (type != LayerTypes::ObjectLayer) throw std::logic_error("TMX FillFromBin error: bad tile collisions layer type: " + std::to_string((int)type));
+						ReadLayerBase(c);
+						ReadTo(c);
+					}
+					o->animation.resize(ReadCount());
+					for (auto&& f : o->animation) {
+						Read(f.tileId, f.gid, f.duration);
+					}
+				}
+				ts.FillTilesById();
+			}
+
+			void Read() {
+				if (!IsBin({ (char*)dr.buf, dr.len })) throw std::logic_error("TMX FillFromBin error: bad magic");
+				dr.offset += binMagic.size();
+
+				Read(map.class_, map.orientation, map.width, map.height, map.tileWidth, map.tileHeight, map.infinite
+					, map.tileSideLength, map.staggeraxis, map.staggerindex, map.parallaxOrigin.x, map.parallaxOrigin.y
+					, map.tileLayerFormat.encoding, map.tileLayerFormat.compression, map.outputChunkWidth, map.outputChunkHeight
+					, map.renderOrder, map.compressionLevel);
+				ReadTo(map.backgroundColor);
+				ReadTo(map.properties);
+				Read(map.version, map.tiledVersion, map.nextLayerId, map.nextObjectId);
+
+				map.images.resize(ReadCount());
+				for (auto&& img : map.images) {
+					img.Emplace();
+					Read(img->source, img->width, img->height);
+					ReadTo(img->transparentColor);
+					if (loadTextures) {
+						img->texture.Emplace(engine.LoadTexture(std::string(rootPath) + img->source));
+					}
+				}
+
+				map.tilesets.resize(ReadCount());
+				for (auto&& ts : map.tilesets) {
+					ReadTo(*ts.Emplace());
+				}
+
+				ReadTo(map.layers);
+
+				// fix object ref
+				for (auto&& [ps, idx] : objProps) {
+					auto& p = (*ps)[idx];
+					auto ordinal = (size_t)std::get<int64_t>(p.value);
+					if (ordinal > objs.size()) throw std::logic_error("TMX FillFromBin error: bad object ordinal = " + std::to_string(ordinal));
+					p.value = ordinal ? objs[ordinal - 1] : nullptr;
+				}
+
+				map.gidInfos.resize(ReadCount());
+				for (auto&& o : map.gidInfos) {
+					o.tileset = ReadPointer(map.tilesets);
+					uint32_t tileIdx;
+					Read(tileIdx);
+					if (tileIdx) {
+						if (!o.tileset || tileIdx > o.tileset->tiles.size()) throw std::logic_error("TMX FillFromBin error: bad tile index = " + std::to_string(tileIdx));
+						o.tile = o.tileset->tiles[tileIdx - 1].get();
+					} else {
+						o.tile = nullptr;
+					}
+					o.image = ReadPointer(map.images);
+					Read(o.u, o.v, o.w, o.h);
+				}
+			}
+		};
+
+		/**************************************************************************************************/
+
+		bool IsBin(std::string_view const& buf) {
+			return buf.size() >= binMagic.size() && memcmp(buf.data(), binMagic.data(), binMagic.size()) == 0;
+		}
+
+		void WriteTo(xx::Data& d, Map const& map) {
+			BinWriter(d, map).Write();
+		}
+
+		void FillFromBin(Map& map, xx::Data_r dr, std::string_view const& rootPath, FillOptions const& opts) {
+			map = {};
+			BinReader(map, dr, rootPath, opts.loadTextures).Read();
+			if (!map.infinite && opts.sparseDensity > 0) {	// same layer storage as the .tmx path
+				std::vector<Layer_Tile*> lts;
+				Fill(lts, map.layers);
+				for (auto& L : lts) {
+					L->TryMakeSparse(opts.sparseDensity);
+				}
+			}
+			if (opts.indexObjects) {
+				BuildObjectIndexs(map);
+			}
+			if (map.infinite) {
+				if (opts.streamChunks) {
+					CompressChunks(map, opts.compressionLevel);
+				} else {
+					DecompressChunks(map);
+				}
+			}
+		}
+	}
+
+}
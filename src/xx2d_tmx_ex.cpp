@@ -4,6 +4,10 @@ namespace xx {
 
 	namespace TMX {
 
+		inline static int32_t FloorDiv(int32_t const& a, int32_t const& b) {
+			return a >= 0 ? a / b : -((-a + b - 1) / b);
+		}
+
 		void Camera::Init(XY const& screenSize, Map& map) {
 			tileWidth = map.tileWidth;
 			tileHeight = map.tileHeight;
@@ -11,18 +15,130 @@ namespace xx {
 			worldRowCount = map.height;
 			worldColumnCount = map.width;
 
-			worldPixel.x = tileWidth * worldColumnCount;
-			worldPixel.y = tileHeight * worldRowCount;
+			orientation = map.orientation;
+			renderOrder = map.renderOrder;
+
+			switch (orientation) {
+			case Orientations::Isometric:
+				worldPixel.x = (worldColumnCount + worldRowCount) * tileWidth / 2.f;
+				worldPixel.y = (worldColumnCount + worldRowCount) * tileHeight / 2.f;
+				break;
+			case Orientations::Staggered:
+			case Orientations::Hexagonal:
+			{
+				tileWidth &= ~1;
+				tileHeight &= ~1;
+				staggerX = map.staggeraxis == StaggerAxiss::X;
+				staggerEven = map.staggerindex == StaggerIndexs::Even;
+				sideLengthX = sideLengthY = 0;
+				if (orientation == Orientations::Hexagonal) {
+					(staggerX ? sideLengthX : sideLengthY) = map.tileSideLength;
+				}
+				columnWidth = (tileWidth - sideLengthX) / 2 + sideLengthX;
+				rowHeight = (tileHeight - sideLengthY) / 2 + sideLengthY;
+				if (staggerX) {
+					worldPixel.x = columnWidth * worldColumnCount + (tileWidth - sideLengthX) / 2;
+					worldPixel.y = (tileHeight + sideLengthY) * worldRowCount + (worldColumnCount > 1 ? rowHeight : 0);
+				} else {
+					worldPixel.x = (tileWidth + sideLengthX) * worldColumnCount + (worldRowCount > 1 ? columnWidth : 0);
+					worldPixel.y = rowHeight * worldRowCount + (tileHeight - sideLengthY) / 2;
+				}
+				break;
+			}
+			default:
+				worldPixel.x = tileWidth * worldColumnCount;
+				worldPixel.y = tileHeight * worldRowCount;
+			}
 
 			this->screenSize = screenSize;
 
 			Commit();
 		}
 
+		XY Camera::GetTilePosition(int32_t const& x, int32_t const& y) const {
+			switch (orientation) {
+			case Orientations::Isometric:
+				return { (x - y) * tileWidth / 2.f + worldRowCount * tileWidth / 2.f - tileWidth / 2.f, (x + y) * tileHeight / 2.f };
+			case Orientations::Staggered:
+			case Orientations::Hexagonal:
+				if (staggerX) {
+					return { float(x * columnWidth), float(y * (tileHeight + sideLengthY) + (((x & 1) ^ staggerEven) ? rowHeight : 0)) };
+				} else {
+					return { float(x * (tileWidth + sideLengthX) + (((y & 1) ^ staggerEven) ? columnWidth : 0)), float(y * rowHeight) };
+				}
+			default:
+				return { float(x * tileWidth), float(y * tileHeight) };
+			}
+		}
+
+		XY Camera::GetTileSize() const {
+			return { (float)tileWidth, (float)tileHeight };
+		}
+
+		void Camera::GetTileBounds(float const& left, float const& top, float const& right, float const& bottom
+			, int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const {
+			// tiles which position in ( lo - size, hi ) by step
+			auto&& Range = [](double lo, double hi, double step, int32_t& from, int32_t& to) {
+				from = (int32_t)std::floor(lo / step);
+				to = (int32_t)std::ceil(hi / step);
+			};
+			double L = left, T = top, R = right, B = bottom;
+			switch (orientation) {
+			case Orientations::Isometric:
+			{
+				// left = ( x - y ) * hw + originX - hw, top = ( x + y ) * hh
+				double hw = tileWidth / 2., hh = tileHeight / 2., originX = worldRowCount * hw;
+				int32_t d0, d1, s0, s1;
+				Range(T - tileHeight, B, hh, d0, d1);
+				Range(L - originX + hw - tileWidth, R - originX + hw, hw, s0, s1);
+				// x = ( d + s ) / 2, y = ( d - s ) / 2
+				x0 = FloorDiv(d0 + s0, 2);
+				x1 = FloorDiv(d1 + s1, 2) + 1;
+				y0 = FloorDiv(d0 - s1, 2);
+				y1 = FloorDiv(d1 - s0, 2) + 1;
+				return;
+			}
+			case Orientations::Staggered:
+			case Orientations::Hexagonal:
+				if (staggerX) {
+					auto stepY = tileHeight + sideLengthY;
+					Range(L - tileWidth, R, columnWidth, x0, x1);
+					Range(T - rowHeight - tileHeight, B, stepY, y0, y1);
+				} else {
+					auto stepX = tileWidth + sideLengthX;
+					Range(L - columnWidth - tileWidth, R, stepX, x0, x1);
+					Range(T - tileHeight, B, rowHeight, y0, y1);
+				}
+				return;
+			default:
+				Range(L - tileWidth, R, tileWidth, x0, x1);
+				Range(T - tileHeight, B, tileHeight, y0, y1);
+				return;
+			}
+		}
+
 		void Camera::Commit() {
 			if (!dirty) return;
 			dirty = false;
 
+			auto halfW = screenSize.x / scale.x / 2, halfH = screenSize.y / scale.y / 2;
+			viewLeft = pos.x - halfW - cullPadding.x;
+			viewRight = pos.x + halfW + cullPadding.x;
+			viewTop = pos.y - halfH - cullPadding.y;
+			viewBottom = pos.y + halfH + cullPadding.y;
+
+			if (orientation != Orientations::Orthogonal) {
+				// O(1): index range of view corners, clamped to map. ForeachVisibleTile walks the exact tiles
+				int32_t x0, y0, x1, y1;
+				GetTileBounds(viewLeft, viewTop, viewRight, viewBottom, x0, y0, x1, y1);
+				columnFrom = std::clamp(x0, 0, worldColumnCount);
+				columnTo = std::clamp(x1 + 1, columnFrom, worldColumnCount);
+				rowFrom = std::clamp(y0, 0, worldRowCount);
+				rowTo = std::clamp(y1 + 1, rowFrom, worldRowCount);
+				at = at.MakePosScale(XY{ -pos.x, pos.y } *scale, scale);
+				return;
+			}
+
 			auto halfNumRows = screenSize.y / scale.y / tileHeight / 2;
 			int32_t posRowIndex = pos.y / tileHeight;
 			rowFrom = posRowIndex - halfNumRows;
@@ -73,6 +189,205 @@ namespace xx {
 			dirty = true;
 		}
 
+		/**********************************************************************************/
+
+		inline static uint64_t MakeChunkKey(int32_t const& cx, int32_t const& cy) {
+			return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+		}
+
+		void ChunkStreamer::Init(Map& map, int const& numThreads) {
+			tp.reset();
+			layers.clear();
+			items.clear();
+			actives.clear();
+			results.clear();
+			numLoadeds = numLoadings = numFaileds = 0;
+
+			std::vector<Layer_Tile*> lts;
+			Fill(lts, map.layers);
+			for (auto& L : lts) {
+				if (L->chunks.empty()) continue;
+				auto&& li = layers.emplace_back();
+				li.layer = L;
+				li.chunkWidth = (int32_t)L->chunks[0].width;
+				li.chunkHeight = (int32_t)L->chunks[0].height;
+				for (auto& c : L->chunks) {
+					auto&& o = items.emplace_back();
+					o.chunk = &c;
+					o.cx = FloorDiv(c.pos.x, li.chunkWidth);
+					o.cy = FloorDiv(c.pos.y, li.chunkHeight);
+					o.layerIndex = uint32_t(layers.size() - 1);
+					o.loaded = !c.gids.empty();	// not a streaming chunk
+					li.items[MakeChunkKey(o.cx, o.cy)] = uint32_t(items.size() - 1);
+				}
+			}
+			tp = std::make_unique<xx::ThreadPool<>>(numThreads);
+		}
+
+		ChunkStreamer::~ChunkStreamer() {
+			tp.reset();
+		}
+
+		void ChunkStreamer::Unload(Item& o) {
+			if (!o.loaded || !o.chunk->zgids.len) return;	// can't reload
+			o.loaded = false;
+			--numLoadeds;
+			if (pool.size() < maxPoolSize) {
+				pool.push_back(std::move(o.chunk->gids));
+				pool.back().clear();
+			}
+			std::vector<uint32_t>().swap(o.chunk->gids);
+		}
+
+		void ChunkStreamer::ApplyResults() {
+			{
+				std::lock_guard<std::mutex> lg(mtx);
+				std::swap(results, tmpResults);
+			}
+			// apply all, then rethrow the first error: every item leaves inFlight, failed one is marked & never posted again until ResetFailed
+			std::exception_ptr ep;
+			for (auto& r : tmpResults) {
+				auto& o = items[r.itemIndex];
+				o.inFlight = false;
+				--numLoadings;
+				if (r.ep) {
+					if (!ep) ep = r.ep;
+					o.failed = true;
+					++numFaileds;
+					if (o.wanted) {
+						o.wanted = false;
+						std::erase(actives, r.itemIndex);
+					}
+				} else if (o.wanted && !o.loaded) {
+					o.chunk->gids = std::move(r.gids);
+					o.loaded = true;
+					++numLoadeds;
+					continue;
+				}
+				if (pool.size() < maxPoolSize) {
+					r.gids.clear();
+					pool.push_back(std::move(r.gids));
+				}
+			}
+			tmpResults.clear();
+			if (ep) std::rethrow_exception(ep);
+		}
+
+		bool ChunkStreamer::IsVisible(Camera const& cam, Item const& o, float const& L, float const& T, float const& R, float const& B) const {
+			auto& li = layers[o.layerIndex];
+			auto x0 = o.cx * li.chunkWidth, y0 = o.cy * li.chunkHeight;
+			auto x1 = x0 + li.chunkWidth - 1, y1 = y0 + li.chunkHeight - 1;
+			// every orientation's position is monotonic by x & y ( except stagger offset ), so corners give the bounding box
+			auto p = cam.GetTilePosition(x0, y0);
+			auto minX = p.x, minY = p.y, maxX = p.x, maxY = p.y;
+			for (auto&& [x, y] : { std::pair{ x1, y0 }, std::pair{ x0, y1 }, std::pair{ x1, y1 } }) {
+				p = cam.GetTilePosition(x, y);
+				minX = std::min(minX, p.x);
+				minY = std::min(minY, p.y);
+				maxX = std::max(maxX, p.x);
+				maxY = std::max(maxY, p.y);
+			}
+			if (cam.orientation == Orientations::Staggered || cam.orientation == Orientations::Hexagonal) {
+				if (cam.staggerX) {
+					minY -= cam.rowHeight;
+					maxY += cam.rowHeight;
+				} else {
+					minX -= cam.columnWidth;
+					maxX += cam.columnWidth;
+				}
+			}
+			return minX < R && maxX + cam.tileWidth > L && minY < B && maxY + cam.tileHeight > T;
+		}
+
+		void ChunkStreamer::Update(Camera const& cam) {
+			ApplyResults();
+
+			// camera's visible rect + margin
+			auto L = cam.viewLeft - marginTiles * cam.tileWidth, R = cam.viewRight + marginTiles * cam.tileWidth;
+			auto T = cam.viewTop - marginTiles * cam.tileHeight, B = cam.viewBottom + marginTiles * cam.tileHeight;
+			int32_t tx0, ty0, tx1, ty1;
+			cam.GetTileBounds(L, T, R, B, tx0, ty0, tx1, ty1);
+
+			// free chunks out of range
+			for (size_t i = actives.size() - 1; i != (size_t)-1; --i) {
+				auto& o = items[actives[i]];
+				if (!IsVisible(cam, o, L, T, R, B)) {
+					o.wanted = false;
+					Unload(o);
+					actives[i] = actives.back();
+					actives.pop_back();
+				}
+			}
+
+			// post decodes for chunks in range
+			for (auto& li : layers) {
+				auto cx0 = FloorDiv(tx0, li.chunkWidth), cx1 = FloorDiv(tx1, li.chunkWidth);
+				auto cy0 = FloorDiv(ty0, li.chunkHeight), cy1 = FloorDiv(ty1, li.chunkHeight);
+				for (auto cy = cy0; cy <= cy1; ++cy) {
+					for (auto cx = cx0; cx <= cx1; ++cx) {
+						auto&& iter = li.items.find(MakeChunkKey(cx, cy));
+						if (iter == li.items.end()) continue;
+						auto idx = iter->second;
+						auto& o = items[idx];
+						if (o.wanted || o.failed || !IsVisible(cam, o, L, T, R, B)) continue;
+						o.wanted = true;
+						actives.push_back(idx);
+						if (o.loaded || o.inFlight) continue;
+						o.inFlight = true;
+						++numLoadings;
+						std::vector<uint32_t> buf;
+						if (!pool.empty()) {
+							buf = std::move(pool.back());
+							pool.pop_back();
+						}
+						tp->Add([this, idx, c = o.chunk, buf = std::move(buf)]() mutable {
+							Result r{ idx };
+							try {
+								DecompressChunkGids(*c, buf);
+							} catch (...) {
+								r.ep = std::current_exception();
+							}
+							r.gids = std::move(buf);
+							{
+								std::lock_guard<std::mutex> lg(mtx);
+								results.push_back(std::move(r));
+							}
+							cv.notify_one();
+						});
+					}
+				}
+			}
+		}
+
+		void ChunkStreamer::Flush() {
+			while (numLoadings) {
+				{
+					std::unique_lock<std::mutex> lg(mtx);
+					cv.wait(lg, [this] { return !results.empty(); });
+				}
+				ApplyResults();
+			}
+		}
+
+		void ChunkStreamer::ResetFailed() {
+			for (auto& o : items) {
+				o.failed = false;
+			}
+			numFaileds = 0;
+		}
+
+		uint32_t ChunkStreamer::GetGid(Layer_Tile const& L, int32_t const& x, int32_t const& y) const {
+			for (auto& li : layers) {
+				if (li.layer != &L) continue;
+				auto&& iter = li.items.find(MakeChunkKey(FloorDiv(x, li.chunkWidth), FloorDiv(y, li.chunkHeight)));
+				if (iter == li.items.end()) return 0;
+				auto& c = *items[iter->second].chunk;
+				if (c.gids.empty()) return 0;
+				return c.gids[(y - c.pos.y) * (int32_t)c.width + (x - c.pos.x)];
+			}
+			return 0;
+		}
+
 	}
 
 }
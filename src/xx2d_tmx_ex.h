@@ -33,9 +33,16 @@ namespace xx {
 			int32_t worldRowCount = 0, worldColumnCount = 0;
 			XY worldPixel{};
 			XY screenSize{};
+			Orientations orientation = Orientations::Orthogonal;
+			RenderOrders renderOrder = RenderOrders::RightDown;
+
+			// staggered & hexagonal params ( same as tiled's HexagonalRenderer::RenderParams )
+			bool staggerX = false, staggerEven = false;
+			int32_t sideLengthX = 0, sideLengthY = 0, columnWidth = 0, rowHeight = 0;
 
 			AffineTransform at;
 			XY pos{}, scale{ 1, 1 };
+			XY cullPadding{};	// expand visible rect( pixels ) for tile images bigger than grid
 			bool dirty = true;
 
 			/*
@@ -43,7 +50,10 @@ namespace xx {
 					for (uint32_t x = cam.columnFrom; x < cam.columnTo; ++x) {
 						auto&& s = ss[y * cam.worldColumnCount + x];
 			*/
-			int32_t rowFrom = 0, rowTo = 0, columnFrom = 0, columnTo = 0;
+			int32_t rowFrom = 0, rowTo = 0, columnFrom = 0, columnTo = 0;	// non orthogonal: clamped GetTileBounds of view rect ( may include a few invisible tiles )
+
+			// visible rect in map pixel space( y down. include cullPadding ). fill by Commit
+			float viewLeft = 0, viewTop = 0, viewRight = 0, viewBottom = 0;
 
 			void Init(XY const& screenSize, Map& map);
 
@@ -55,6 +65,103 @@ namespace xx {
 
 			// call after set xxxx ...
 			void Commit();
+
+			// tile's bounding box left top position in map pixel space( y down )
+			XY GetTilePosition(int32_t const& x, int32_t const& y) const;
+
+			// tile's bounding box size
+			XY GetTileSize() const;
+
+			// bounding index range [ x0, x1 ] * [ y0, y1 ] of tiles which bounding box may intersect rect( map pixel space, y down )
+			// not clamped by world size ( infinite map's chunks can be negative )
+			void GetTileBounds(float const& left, float const& top, float const& right, float const& bottom
+				, int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const;
+
+			// f( x, y ) for every tile's bounding box intersect with visible rect, by painter's order of orientation:
+			// orthogonal: renderOrder. isometric: x + y asc, x asc. stagger y: y asc, x asc. stagger x: y asc, upper columns first
+			template<typename F>
+			void ForeachVisibleTile(F&& f) const {
+				// fill [ from, to ] by n * step in ( lo, hi ), clamp to [ 0, count )
+				auto&& Range = [](double lo, double hi, double step, int32_t count, int32_t& from, int32_t& to) {
+					from = std::max(0, (int32_t)std::floor(lo / step) + 1);
+					to = std::min(count - 1, (int32_t)std::ceil(hi / step) - 1);
+				};
+				double L = viewLeft, T = viewTop, R = viewRight, B = viewBottom;
+				int32_t x0, x1, y0, y1;
+				switch (orientation) {
+				case Orientations::Orthogonal:
+				{
+					Range(L - tileWidth, R, tileWidth, worldColumnCount, x0, x1);
+					Range(T - tileHeight, B, tileHeight, worldRowCount, y0, y1);
+					if (x0 > x1 || y0 > y1) return;
+					bool up = renderOrder == RenderOrders::RightUp || renderOrder == RenderOrders::LeftUp;
+					bool left = renderOrder == RenderOrders::LeftDown || renderOrder == RenderOrders::LeftUp;
+					for (int32_t i = y0; i <= y1; ++i) {
+						auto y = up ? y1 - (i - y0) : i;
+						for (int32_t j = x0; j <= x1; ++j) {
+							f(left ? x1 - (j - x0) : j, y);
+						}
+					}
+					return;
+				}
+				case Orientations::Isometric:
+				{
+					// left = ( x - y ) * hw + originX - hw, top = ( x + y ) * hh
+					double hw = tileWidth / 2., hh = tileHeight / 2., originX = worldRowCount * hw;
+					int32_t d0, d1, s0, s1;
+					Range(T - tileHeight, B, hh, worldColumnCount + worldRowCount - 1, d0, d1);
+					auto sLo = (L - originX + hw - tileWidth) / hw, sHi = (R - originX + hw) / hw;
+					s0 = (int32_t)std::floor(sLo) + 1;
+					s1 = (int32_t)std::ceil(sHi) - 1;
+					for (auto d = d0; d <= d1; ++d) {
+						// x - y == s, x + y == d  ->  x = ( d + s ) / 2
+						auto xa = std::max({ 0, d - (worldRowCount - 1), (int32_t)std::ceil((d + s0) / 2.) });
+						auto xb = std::min({ worldColumnCount - 1, d, (int32_t)std::floor((d + s1) / 2.) });
+						for (auto x = xa; x <= xb; ++x) {
+							f(x, d - x);
+						}
+					}
+					return;
+				}
+				case Orientations::Staggered:
+				case Orientations::Hexagonal:
+				{
+					if (staggerX) {
+						Range(L - tileWidth, R, columnWidth, worldColumnCount, x0, x1);
+						auto stepY = tileHeight + sideLengthY;
+						int32_t ya0, ya1, yb0, yb1;	// a: upper columns, b: lower( staggered ) columns
+						Range(T - tileHeight, B, stepY, worldRowCount, ya0, ya1);
+						Range(T - rowHeight - tileHeight, B - rowHeight, stepY, worldRowCount, yb0, yb1);
+						int32_t bParity = staggerEven ? 0 : 1;
+						for (auto y = std::min(ya0, yb0), e = std::max(ya1, yb1); y <= e; ++y) {
+							if (y >= ya0 && y <= ya1) {
+								for (auto x = x0 + ((x0 & 1) == bParity ? 1 : 0); x <= x1; x += 2) {
+									f(x, y);
+								}
+							}
+							if (y >= yb0 && y <= yb1) {
+								for (auto x = x0 + ((x0 & 1) == bParity ? 0 : 1); x <= x1; x += 2) {
+									f(x, y);
+								}
+							}
+						}
+					} else {
+						Range(T - tileHeight, B, rowHeight, worldRowCount, y0, y1);
+						auto stepX = tileWidth + sideLengthX;
+						for (auto y = y0; y <= y1; ++y) {
+							auto offset = ((y & 1) ^ staggerEven) ? columnWidth : 0;
+							Range(L - offset - tileWidth, R - offset, stepX, worldColumnCount, x0, x1);
+							for (auto x = x0; x <= x1; ++x) {
+								f(x, y);
+							}
+						}
+					}
+					return;
+				}
+				default:
+					return;
+				}
+			}
 		};
 
 
@@ -91,6 +198,65 @@ namespace xx {
 			}
 			return nullptr;
 		}
+
+
+		// stream infinite map's tile layer chunks ( FillTo with FillOptions::streamChunks )
+		// decode Chunk.zgids on worker threads when chunk's bounding box enter camera's view + margin, free gids when leave
+		// support every orientation ( by Camera's GetTileBounds & GetTilePosition ). soak benchmark: bench/tmx_chunk_streamer.cpp
+		struct ChunkStreamer {
+			int32_t marginTiles = 8;	// extra tiles around camera's view
+			size_t maxPoolSize = 64;	// max cached gids buffers
+
+			// stat
+			size_t numLoadeds = 0, numLoadings = 0, numFaileds = 0;
+
+			void Init(Map& map, int const& numThreads = 2);
+
+			// call after cam.Commit() every frame: apply finished decodes, post new decodes, free far chunks
+			// a chunk which decode failed throws once ( from here or Flush ), then is skipped until ResetFailed
+			void Update(Camera const& cam);
+
+			// wait & apply all posted decodes
+			void Flush();
+
+			// allow failed chunks to be posted again ( e.g. after repair Chunk::zgids )
+			void ResetFailed();
+
+			// return 0 when not loaded or empty
+			uint32_t GetGid(Layer_Tile const& L, int32_t const& x, int32_t const& y) const;
+
+			~ChunkStreamer();
+
+		protected:
+			struct Item {
+				Chunk* chunk;
+				int32_t cx, cy;
+				uint32_t layerIndex;
+				bool wanted = false, loaded = false, inFlight = false, failed = false;
+			};
+			struct LayerInfo {
+				Layer_Tile* layer;
+				int32_t chunkWidth, chunkHeight;
+				std::unordered_map<uint64_t, uint32_t> items;	// key: cx, cy  value: items index
+			};
+			struct Result {
+				uint32_t itemIndex;
+				std::vector<uint32_t> gids;
+				std::exception_ptr ep;
+			};
+			std::vector<LayerInfo> layers;
+			std::vector<Item> items;
+			std::vector<uint32_t> actives;	// wanted items
+			std::vector<std::vector<uint32_t>> pool;	// recycled gids buffers
+			std::vector<Result> results, tmpResults;	// results: guard by mtx
+			std::mutex mtx;
+			std::condition_variable cv;	// workers notify when push results
+			std::unique_ptr<xx::ThreadPool<>> tp;	// keep last: stop threads before other members destruct
+
+			void ApplyResults();
+			void Unload(Item& o);
+			bool IsVisible(Camera const& cam, Item const& o, float const& L, float const& T, float const& R, float const& B) const;
+		};
 	}
 
 }
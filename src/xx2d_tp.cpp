@@ -11,15 +11,18 @@ namespace xx {
 			if (auto&& i = fp.find_last_of("/"); i != fp.npos) {
 				rootPath = fp.substr(0, i + 1);
 			}
-			if (int r = Fill(d, rootPath)) {
+			if (IsTpb(d)) {
+				if (int r = FillFromTpb(d, rootPath)) {
+					throw std::logic_error(xx::ToString("read tpb file content error: r = ", r, ", fn = ", fp));
+				}
+				sortByName = false;	// sorted by compiler
+			} else if (int r = Fill(d, rootPath)) {
 				throw std::logic_error(xx::ToString("parse plist file content error: r = ", r, ", fn = ", fp));
 			}
 		}
 
 		if (sortByName) {
-			std::sort(frames.begin(), frames.end(), [](xx::Shared<Frame> const& a, xx::Shared<Frame> const& b) {
-				return xx::InnerNumberToFixed(a->key) < xx::InnerNumberToFixed(b->key);
-				});
+			SortByName(frames);
 		}
 
 		auto tex = xx::Make<GLTexture>(engine.LoadTexture(realTextureFileName));
@@ -157,13 +160,111 @@ namespace xx {
 		// realTextureFileName
 		if (i = text.find("<s"sv); i == text.npos) return __LINE__;				// <string> tex file name .ext
 		if (j = text.find('<', i + 8); j == text.npos) return __LINE__;			// </string>
+		textureFileName = CutStr(text, i + 8, j - i - 8);
 		realTextureFileName = rootPath;
-		realTextureFileName.append(CutStr(text, i + 8, j - i - 8));
+		realTextureFileName.append(textureFileName);
 
 		return 0;
 	}
 
 
+	void TP::SortByName(std::vector<xx::Shared<Frame>>& fs) {
+		// make sort keys once ( avoid string alloc in comparer )
+		std::vector<std::pair<std::string, xx::Shared<Frame>>> kfs;
+		kfs.reserve(fs.size());
+		for (auto& f : fs) {
+			kfs.emplace_back(xx::InnerNumberToFixed(f->key), std::move(f));
+		}
+		std::sort(kfs.begin(), kfs.end(), [](auto const& a, auto const& b) {
+			return a.first < b.first;
+			});
+		for (size_t i = 0, e = kfs.size(); i < e; ++i) {
+			fs[i] = std::move(kfs[i].second);
+		}
+	}
+
+	bool TP::IsTpb(std::string_view const& buf) {
+		return buf.size() >= tpbMagic.size() && memcmp(buf.data(), tpbMagic.data(), tpbMagic.size()) == 0;
+	}
+
+	template<typename T>
+	inline static void WriteTpbArray(xx::Data& d, std::vector<T> const& vs) {
+		d.WriteVarInteger(vs.size());
+		if (vs.empty()) return;
+		d.WriteFixedArray(vs.data(), vs.size());
+	}
+
+	template<typename T>
+	inline static int ReadTpbArray(xx::Data_r& dr, std::vector<T>& vs) {
+		size_t siz;
+		if (int r = dr.ReadVarInteger(siz)) return r;
+		if (siz > dr.LeftLen() / sizeof(T)) return __LINE__;
+		vs.resize(siz);
+		if (!siz) return 0;
+		return dr.ReadFixedArray(vs.data(), siz);
+	}
+
+	void TP::WriteTo(xx::Data& d) const {
+		d.WriteBuf(tpbMagic.data(), tpbMagic.size());
+		d.WriteFixed((uint8_t)premultiplyAlpha);
+		d.Write(textureFileName);	// rootPath will be prepend when load
+		auto fs = frames;	// loader skips the sort for .tpb: always write sorted, whatever Fill path made frames
+		SortByName(fs);
+		d.WriteVarInteger(fs.size());
+		for (auto& f : fs) {
+			d.Write(f->key);
+			d.WriteFixed((uint8_t)f->anchor.has_value());
+			if (f->anchor.has_value()) {
+				d.WriteFixedArray(&f->anchor->x, 2);
+			}
+			d.WriteFixedArray(&f->spriteOffset.x, 2);
+			d.WriteFixedArray(&f->spriteSize.x, 2);
+			d.WriteFixedArray(&f->spriteSourceSize.x, 2);
+			d.WriteFixedArray(&f->textureRect.x, 4);
+			d.WriteFixed((uint8_t)f->textureRotated);
+			WriteTpbArray(d, f->triangles);
+			WriteTpbArray(d, f->vertices);
+			WriteTpbArray(d, f->verticesUV);
+		}
+	}
+
+	int TP::FillFromTpb(xx::Data_r dr, std::string_view const& rootPath) {
+		static_assert(sizeof(Rect) == sizeof(float) * 4);
+		frames.clear();
+		if (!IsTpb(dr)) return __LINE__;
+		dr.offset += tpbMagic.size();
+		uint8_t b;
+		std::string_view sv;
+		size_t siz;
+		if (int r = dr.ReadFixed(b)) return r;
+		premultiplyAlpha = b;
+		if (int r = dr.Read(sv)) return r;
+		textureFileName = sv;
+		realTextureFileName = rootPath;
+		realTextureFileName.append(sv);
+		if (int r = dr.ReadVarInteger(siz)) return r;
+		if (siz > dr.LeftLen()) return __LINE__;
+		frames.resize(siz);
+		for (auto& f : frames) {
+			auto&& o = *f.Emplace();
+			if (int r = dr.Read(o.key)) return r;
+			if (int r = dr.ReadFixed(b)) return r;
+			if (b) {
+				if (int r = dr.ReadFixedArray(&o.anchor.emplace().x, 2)) return r;
+			}
+			if (int r = dr.ReadFixedArray(&o.spriteOffset.x, 2)) return r;
+			if (int r = dr.ReadFixedArray(&o.spriteSize.x, 2)) return r;
+			if (int r = dr.ReadFixedArray(&o.spriteSourceSize.x, 2)) return r;
+			if (int r = dr.ReadFixedArray(&o.textureRect.x, 4)) return r;
+			if (int r = dr.ReadFixed(b)) return r;
+			o.textureRotated = b;
+			if (int r = ReadTpbArray(dr, o.triangles)) return r;
+			if (int r = ReadTpbArray(dr, o.vertices)) return r;
+			if (int r = ReadTpbArray(dr, o.verticesUV)) return r;
+		}
+		return 0;
+	}
+
 	xx::Shared<Frame> const& TP::Get(std::string_view const& key) const {
 		for (auto& f : frames) {
 			if (f->key == key) return f;
@@ -7,15 +7,29 @@ namespace xx {
 	struct TP {
 		std::vector<xx::Shared<Frame>> frames;
 		bool premultiplyAlpha;
-		std::string realTextureFileName;
+		std::string realTextureFileName;	// rootPath + textureFileName
+		std::string textureFileName;		// as written in plist ( relative to plist's dir, may contain sub dirs ). .tpb stores this
 		std::string plistFullPath;
 
-		// fill below fields by plist file
+		// fill below fields by plist or .tpb file
 		void Fill(std::string_view plistFn, bool sortByName = true);
 
 		// fill by plist file's content
 		int Fill(std::string_view text, std::string_view const& rootPath);
 
+		// precompiled binary( .tpb ) format: frames are sorted, polygon data & flip y are applied. load without parse & sort
+		inline static constexpr std::array<uint8_t, 4> tpbMagic{ 't', 'p', 'b', 1 };
+		static bool IsTpb(std::string_view const& buf);
+
+		// fill by .tpb file's content. return 0 mean success
+		int FillFromTpb(xx::Data_r dr, std::string_view const& rootPath);
+
+		// sort by key ( inner numbers compare as numbers: a9 < a10 ). used by Fill( plistFn ) & WriteTo
+		static void SortByName(std::vector<xx::Shared<Frame>>& fs);
+
+		// offline compile: Fill( plist text ) + WriteTo ( frames are written sorted by SortByName ) + WriteAllBytes( .tpb ). no gl needed. tool: tools_tp_compile. load speed vs plist: bench/tp_load.cpp
+		void WriteTo(xx::Data& d) const;
+
 		// get frame by key
 		xx::Shared<Frame> const& Get(std::string_view const& key) const;
 		xx::Shared<Frame> const& Get(char const* const& buf, size_t const& len) const;
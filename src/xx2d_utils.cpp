@@ -1,17 +1,240 @@
 ﻿#include "xx2d.h"
 #include <zstd.h>
+#include <zdict.h>
 
 namespace xx {
 
+	// shared dictionaries. key: dict id. zstdDictsVersion: ++ when zstdDicts changed ( thread caches drop stale items )
+	inline static std::mutex zstdDictsMutex;
+	inline static std::unordered_map<uint32_t, std::shared_ptr<ZSTD_DDict>> zstdDicts;
+	inline static std::atomic<uint64_t> zstdDictsVersion{ 1 };
+
+	// per thread reuse decompress context & dictionary cache ( hit: no lock, no shared_ptr copy )
+	struct ZstdDCtx {
+		ZSTD_DCtx* ctx = ZSTD_createDCtx();
+		uint64_t dictsVersion{};
+		std::unordered_map<uint32_t, std::shared_ptr<ZSTD_DDict>> dicts;
+		~ZstdDCtx() {
+			ZSTD_freeDCtx(ctx);
+		}
+	};
+	inline static thread_local ZstdDCtx zstdDCtx;
+
+	// returned dict is kept alive by this thread's cache until next ZstdDictGet
+	inline static ZSTD_DDict* ZstdDictGet(std::string_view const& src) {
+		auto id = ZSTD_getDictID_fromFrame(src.data(), src.size());
+		if (!id) return {};
+		auto&& c = zstdDCtx;
+		if (auto v = zstdDictsVersion.load(std::memory_order_acquire); v != c.dictsVersion) {
+			c.dicts.clear();
+			c.dictsVersion = v;
+		} else if (auto iter = c.dicts.find(id); iter != c.dicts.end()) {
+			return iter->second.get();
+		}
+		std::lock_guard<std::mutex> lg(zstdDictsMutex);
+		if (auto iter = zstdDicts.find(id); iter != zstdDicts.end()) {
+			return c.dicts.emplace(id, iter->second).first->second.get();
+		}
+		throw std::logic_error(xx::ToString("ZstdDecompress error: can't find dict. id = ", id));
+	}
+
 	void ZstdDecompress(std::string_view const& src, xx::Data& dst) {
 		auto&& siz = ZSTD_getFrameContentSize(src.data(), src.size());
-		if (ZSTD_CONTENTSIZE_UNKNOWN == siz) throw std::logic_error("ZstdDecompress error: unknown content size.");
+		if (ZSTD_CONTENTSIZE_UNKNOWN == siz) return ZstdDecompressStream(src, dst);
 		if (ZSTD_CONTENTSIZE_ERROR == siz) throw std::logic_error("ZstdDecompress read content size error.");
 		dst.Resize(siz);
 		if (0 == siz) return;
-		siz = ZSTD_decompress(dst.buf, siz, src.data(), src.size());
+		if (auto&& dict = ZstdDictGet(src)) {
+			siz = ZSTD_decompress_usingDDict(zstdDCtx.ctx, dst.buf, siz, src.data(), src.size(), dict);
+		} else {
+			siz = ZSTD_decompressDCtx(zstdDCtx.ctx, dst.buf, siz, src.data(), src.size());
+		}
 		if (ZSTD_isError(siz)) throw std::logic_error("ZstdDecompress decompress error.");
 		dst.Resize(siz);
 	}
 
+	void ZstdDecompressStream(std::string_view const& src, xx::Data& dst) {
+		auto&& ctx = zstdDCtx.ctx;
+		auto&& dict = ZstdDictGet(src);
+		ZSTD_DCtx_reset(ctx, ZSTD_reset_session_only);
+		ZSTD_DCtx_refDDict(ctx, dict);
+		auto sg = MakeScopeGuard([&] {
+			ZSTD_DCtx_refDDict(ctx, nullptr);
+		});
+
+		dst.Clear();
+		auto&& step = ZSTD_DStreamOutSize();
+		ZSTD_inBuffer in{ src.data(), src.size(), 0 };
+		while (true) {
+			if (dst.cap - dst.len < step) {
+				dst.Reserve(dst.len + step);
+			}
+			ZSTD_outBuffer out{ dst.buf + dst.len, dst.cap - dst.len, 0 };
+			auto&& r = ZSTD_decompressStream(ctx, &out, &in);
+			if (ZSTD_isError(r)) throw std::logic_error("ZstdDecompressStream decompress error.");
+			dst.len += out.pos;
+			if (!r) {
+				if (in.pos == in.size) return;	// frame finished & no more input
+			} else if (in.pos == in.size && out.pos < out.size) {
+				throw std::logic_error("ZstdDecompressStream error: truncated frame.");
+			}
+		}
+	}
+
+	void ZstdCompress(std::string_view const& src, Data& dst, int const& level, std::string_view const& dict) {
+		auto&& ctx = ZSTD_createCCtx();
+		auto sg = MakeScopeGuard([&] {
+			ZSTD_freeCCtx(ctx);
+		});
+		dst.Resize(ZSTD_compressBound(src.size()));
+		size_t siz;
+		if (dict.empty()) {
+			siz = ZSTD_compressCCtx(ctx, dst.buf, dst.len, src.data(), src.size(), level);
+		} else {
+			siz = ZSTD_compress_usingDict(ctx, dst.buf, dst.len, src.data(), src.size(), dict.data(), dict.size(), level);
+		}
+		if (ZSTD_isError(siz)) throw std::logic_error(xx::ToString("ZstdCompress error: ", ZSTD_getErrorName(siz)));
+		dst.Resize(siz);
+	}
+
+	uint32_t ZstdTrainDict(std::vector<std::string_view> const& samples, Data& dst, size_t const& dictCap) {
+		xx::Data buf;
+		std::vector<size_t> sizs;
+		sizs.reserve(samples.size());
+		for (auto& s : samples) {
+			buf.WriteBuf(s);
+			sizs.push_back(s.size());
+		}
+		dst.Resize(dictCap);
+		auto&& siz = ZDICT_trainFromBuffer(dst.buf, dst.len, buf.buf, sizs.data(), (unsigned)sizs.size());
+		if (ZDICT_isError(siz)) throw std::logic_error(xx::ToString("ZstdTrainDict error: ", ZDICT_getErrorName(siz)));
+		dst.Resize(siz);
+		return ZSTD_getDictID_fromDict(dst.buf, dst.len);
+	}
+
+	bool IsZstdChunked(std::string_view const& src) {
+		return src.size() >= 4 && memcmp(src.data(), zstdChunkedMagic.data(), 4) == 0;
+	}
+
+	ThreadPool<>& ZstdThreadPool() {
+		static ThreadPool<> tp((int)std::max(1u, std::thread::hardware_concurrency()));
+		return tp;
+	}
+
+	// split [0, numBlocks) to caller + numThreads - 1 pool jobs by atomic cursor, first exception rethrow at caller thread
+	template<typename F>
+	inline static void ZstdForeachBlock(uint32_t const& numBlocks, size_t numThreads, ThreadPool<>* tp, F&& f) {
+		if (!numThreads) {
+			numThreads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		if (numThreads > numBlocks) {
+			numThreads = numBlocks;
+		}
+		std::atomic<uint32_t> cursor{};
+		std::exception_ptr ep;
+		std::mutex epMutex;
+		auto&& job = [&] {
+			try {
+				for (uint32_t i; (i = cursor++) < numBlocks;) {
+					f(i);
+				}
+			} catch (...) {
+				cursor = numBlocks;
+				std::lock_guard<std::mutex> lg(epMutex);
+				if (!ep) ep = std::current_exception();
+			}
+		};
+		if (numThreads <= 1) {
+			job();
+		} else {
+			if (!tp) {
+				tp = &ZstdThreadPool();
+			}
+			std::latch done((ptrdiff_t)numThreads - 1);
+			for (size_t i = 1; i < numThreads; ++i) {
+				tp->Add([&] {
+					job();
+					done.count_down();
+				});
+			}
+			job();
+			done.wait();
+		}
+		if (ep) std::rethrow_exception(ep);
+	}
+
+	void ZstdCompressChunked(std::string_view const& src, Data& dst, size_t const& blockSize, int const& level, size_t numThreads, ThreadPool<>* tp) {
+		if (!blockSize || blockSize > std::numeric_limits<uint32_t>::max()) throw std::logic_error("ZstdCompressChunked error: bad block size.");
+		auto numBlocks = (src.size() + blockSize - 1) / blockSize;
+		if (numBlocks > std::numeric_limits<uint32_t>::max()) throw std::logic_error("ZstdCompressChunked error: too many blocks.");
+		std::vector<xx::Data> blocks(numBlocks);
+		ZstdForeachBlock((uint32_t)numBlocks, numThreads, tp, [&](uint32_t const& i) {
+			auto siz = std::min(blockSize, src.size() - i * blockSize);
+			ZstdCompress(src.substr(i * blockSize, siz), blocks[i], level);
+		});
+		dst.Clear();
+		dst.WriteBuf(zstdChunkedMagic.data(), zstdChunkedMagic.size());
+		dst.WriteFixed((uint64_t)src.size());
+		dst.WriteFixed((uint32_t)blockSize);
+		dst.WriteFixed((uint32_t)numBlocks);
+		for (auto& b : blocks) {
+			dst.WriteFixed((uint32_t)b.len);
+		}
+		for (auto& b : blocks) {
+			dst.WriteBuf(b.buf, b.len);
+		}
+	}
+
+	void ZstdDecompressChunked(std::string_view const& src, Data& dst, size_t numThreads, ThreadPool<>* tp) {
+		if (!IsZstdChunked(src)) throw std::logic_error("ZstdDecompressChunked error: bad magic.");
+		xx::Data_r dr(src.data(), src.size(), zstdChunkedMagic.size());
+		uint64_t rawLen;
+		uint32_t blockSize, numBlocks;
+		if (dr.ReadFixed(rawLen) || dr.ReadFixed(blockSize) || dr.ReadFixed(numBlocks)) throw std::logic_error("ZstdDecompressChunked error: read header failed.");
+		if (rawLen > std::numeric_limits<size_t>::max() || !blockSize || (rawLen + blockSize - 1) / blockSize != numBlocks) throw std::logic_error("ZstdDecompressChunked error: bad header.");
+		if (dr.LeftLen() < (size_t)numBlocks * 4) throw std::logic_error("ZstdDecompressChunked error: bad block index.");
+
+		// block index -> offsets
+		std::vector<std::pair<size_t, uint32_t>> blocks(numBlocks);	// offset, len
+		auto offset = dr.offset + (size_t)numBlocks * 4;
+		for (auto& b : blocks) {
+			if (dr.ReadFixed(b.second)) throw std::logic_error("ZstdDecompressChunked error: bad block index.");
+			b.first = offset;
+			offset += b.second;
+		}
+		if (offset != src.size()) throw std::logic_error("ZstdDecompressChunked error: bad block index.");
+
+		dst.Resize((size_t)rawLen);
+		ZstdForeachBlock(numBlocks, numThreads, tp, [&](uint32_t const& i) {
+			auto&& [bo, bl] = blocks[i];
+			auto siz = std::min((uint64_t)blockSize, rawLen - (uint64_t)i * blockSize);
+			auto r = ZSTD_decompressDCtx(zstdDCtx.ctx, dst.buf + (size_t)i * blockSize, (size_t)siz, src.data() + bo, bl);
+			if (ZSTD_isError(r) || r != siz) throw std::logic_error(xx::ToString("ZstdDecompressChunked error: bad block. index = ", i));
+		});
+	}
+
+	uint32_t ZstdDictAdd(std::string_view const& dict) {
+		auto&& d = ZSTD_createDDict(dict.data(), dict.size());
+		if (!d) throw std::logic_error("ZstdDictAdd error: bad dict data.");
+		std::shared_ptr<ZSTD_DDict> sd(d, [](ZSTD_DDict* p) { ZSTD_freeDDict(p); });
+		auto&& id = ZSTD_getDictID_fromDDict(d);
+		if (!id) throw std::logic_error("ZstdDictAdd error: dict id == 0 ( raw content dict is not supported ).");
+		std::lock_guard<std::mutex> lg(zstdDictsMutex);
+		zstdDicts[id] = std::move(sd);
+		++zstdDictsVersion;
+		return id;
+	}
+
+	void ZstdDictRemove(uint32_t const& dictId) {
+		std::lock_guard<std::mutex> lg(zstdDictsMutex);
+		zstdDicts.erase(dictId);
+		++zstdDictsVersion;
+	}
+
+	void ZstdDictClear() {
+		std::lock_guard<std::mutex> lg(zstdDictsMutex);
+		zstdDicts.clear();
+		++zstdDictsVersion;
+	}
+
 }
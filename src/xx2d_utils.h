@@ -3,6 +3,38 @@
 
 namespace xx {
 
+    // decompress zstd data. frame's dict id != 0 will use the registered dictionary( ZstdDictAdd )
+    // unknown content size frame will fall back to streaming decompress. context is reused per thread
     void ZstdDecompress(std::string_view const& src, Data& dst);
 
+    // streaming decompress ( for frames without content size ). dst grows as needed
+    void ZstdDecompressStream(std::string_view const& src, Data& dst);
+
+    // for tools: compress src to dst. dict == empty: no dictionary
+    void ZstdCompress(std::string_view const& src, Data& dst, int const& level = 3, std::string_view const& dict = {});
+
+    // for tools: train a dictionary by small & similar files. return dict id. size & speed with / without it: bench/zstd_dict.cpp
+    uint32_t ZstdTrainDict(std::vector<std::string_view> const& samples, Data& dst, size_t const& dictCap = 112640);
+
+    // register / unregister shared decompress dictionary( thread safe ). return dict id
+    // decompress threads cache dicts ( lock only on miss ). removed dict is freed after every thread's next dict lookup
+    uint32_t ZstdDictAdd(std::string_view const& dict);
+    void ZstdDictRemove(uint32_t const& dictId);
+    void ZstdDictClear();
+
+    // chunked container for big assets: independent compressed blocks + block index, decompress in parallel
+    // format: "xxzc" + rawLen( u64 ) + blockSize( u32 ) + numBlocks( u32 ) + blockLens( u32 * numBlocks ) + blocks...
+    inline static constexpr std::array<uint8_t, 4> zstdChunkedMagic{ 'x', 'x', 'z', 'c' };
+    bool IsZstdChunked(std::string_view const& src);
+
+    // long-lived workers for chunked compress / decompress ( worker keeps its zstd context ). created at first use
+    // hardware_concurrency threads. don't call chunked funcs with it from its own jobs ( caller waits for them )
+    ThreadPool<>& ZstdThreadPool();
+
+    // for tools. numThreads == 0: hardware_concurrency. tp == nullptr: ZstdThreadPool()
+    void ZstdCompressChunked(std::string_view const& src, Data& dst, size_t const& blockSize = 4 * 1024 * 1024, int const& level = 3, size_t numThreads = 0, ThreadPool<>* tp = nullptr);
+
+    // decompress blocks in parallel into dst. numThreads == 0: hardware_concurrency. tp == nullptr: ZstdThreadPool()
+    // speed by threads: bench/zstd_chunked.cpp
+    void ZstdDecompressChunked(std::string_view const& src, Data& dst, size_t numThreads = 0, ThreadPool<>* tp = nullptr);
 }
@@ -0,0 +1,153 @@
+﻿#include "xx2d.h"
+
+// headless test: TMX::Camera::ForeachVisibleTile returns exactly the tiles which bounding box intersect the view rect,
+// in painter's order, for every orientation / render order / stagger axis / stagger index
+// reference projection is tiled's MapRenderer::tileToScreenCoords ( isometric & hexagonal renderer ), not Camera::GetTilePosition
+
+using namespace xx::TMX;
+
+struct RefRenderer {
+	Map const& map;
+	double tileWidth, tileHeight;
+	int32_t sideLengthX = 0, sideLengthY = 0, columnWidth = 0, rowHeight = 0;
+	bool staggerX = false, staggerEven = false;
+
+	explicit RefRenderer(Map const& map) : map(map) {
+		tileWidth = map.tileWidth;
+		tileHeight = map.tileHeight;
+		if (map.orientation == Orientations::Staggered || map.orientation == Orientations::Hexagonal) {
+			// HexagonalRenderer::RenderParams ( staggered == hexagonal with side length 0 )
+			int32_t tw = map.tileWidth & ~1, th = map.tileHeight & ~1;
+			tileWidth = tw;
+			tileHeight = th;
+			staggerX = map.staggeraxis == StaggerAxiss::X;
+			staggerEven = map.staggerindex == StaggerIndexs::Even;
+			if (map.orientation == Orientations::Hexagonal) {
+				if (staggerX) sideLengthX = map.tileSideLength;
+				else sideLengthY = map.tileSideLength;
+			}
+			columnWidth = (tw - sideLengthX) / 2 + sideLengthX;
+			rowHeight = (th - sideLengthY) / 2 + sideLengthY;
+		}
+	}
+
+	bool DoStagger(int32_t i) const {
+		return (i & 1) ^ staggerEven;
+	}
+
+	// tile's bounding box left top
+	std::pair<double, double> LeftTop(int32_t x, int32_t y) const {
+		switch (map.orientation) {
+		case Orientations::Isometric:
+		{
+			// screen pos is the top corner of diamond
+			auto originX = map.height * tileWidth / 2;
+			auto sx = (x - y) * tileWidth / 2 + originX;
+			auto sy = (x + y) * tileHeight / 2;
+			return { sx - tileWidth / 2, sy };
+		}
+		case Orientations::Staggered:
+		case Orientations::Hexagonal:
+			if (staggerX) {
+				double py = y * (tileHeight + sideLengthY);
+				if (DoStagger(x)) py += rowHeight;
+				return { double(x * columnWidth), py };
+			} else {
+				double px = x * (tileWidth + sideLengthX);
+				if (DoStagger(y)) px += columnWidth;
+				return { px, double(y * rowHeight) };
+			}
+		default:
+			return { x * tileWidth, y * tileHeight };
+		}
+	}
+
+	// true: a draw before b
+	bool Before(std::pair<int32_t, int32_t> const& a, std::pair<int32_t, int32_t> const& b) const {
+		auto [ax, ay] = a;
+		auto [bx, by] = b;
+		switch (map.orientation) {
+		case Orientations::Isometric:
+			return std::tuple(ax + ay, ax) < std::tuple(bx + by, bx);
+		case Orientations::Staggered:
+		case Orientations::Hexagonal:
+			if (staggerX) return std::tuple(ay, DoStagger(ax), ax) < std::tuple(by, DoStagger(bx), bx);
+			return std::tuple(ay, ax) < std::tuple(by, bx);
+		default:
+		{
+			bool up = map.renderOrder == RenderOrders::RightUp || map.renderOrder == RenderOrders::LeftUp;
+			bool left = map.renderOrder == RenderOrders::LeftDown || map.renderOrder == RenderOrders::LeftUp;
+			auto ky = [&](int32_t y) { return up ? -y : y; };
+			auto kx = [&](int32_t x) { return left ? -x : x; };
+			return std::tuple(ky(ay), kx(ax)) < std::tuple(ky(by), kx(bx));
+		}
+		}
+	}
+};
+
+int main() {
+	std::mt19937 rng(7);
+	std::map<std::string, std::pair<int, int>> stats;	// case name : rounds, fails
+	int numFails = 0;
+	for (int round = 0; round < 30000; ++round) {
+		Map map;
+		map.orientation = (Orientations)(rng() % 4);
+		map.renderOrder = (RenderOrders)(rng() % 4);
+		map.width = 1 + rng() % 40;
+		map.height = 1 + rng() % 40;
+		map.tileWidth = 8 + rng() % 60;
+		map.tileHeight = 8 + rng() % 60;
+		map.staggeraxis = (StaggerAxiss)(rng() % 2);
+		map.staggerindex = (StaggerIndexs)(rng() % 2);
+		map.tileSideLength = rng() % 20;
+
+		Camera cam;
+		cam.Init({ float(50 + rng() % 900), float(50 + rng() % 700) }, map);
+		cam.SetScale(0.3f + (rng() % 100) / 40.f);
+		cam.SetPosition({ float((int)(rng() % (int)(cam.worldPixel.x + 200)) - 100), float((int)(rng() % (int)(cam.worldPixel.y + 200)) - 100) });
+		cam.cullPadding = { float(rng() % 30), float(rng() % 30) };
+		cam.Commit();
+
+		std::vector<std::pair<int32_t, int32_t>> a, b;
+		cam.ForeachVisibleTile([&](int32_t x, int32_t y) { a.emplace_back(x, y); });
+
+		RefRenderer ref(map);
+		for (int32_t y = 0; y < (int32_t)map.height; ++y) {
+			for (int32_t x = 0; x < (int32_t)map.width; ++x) {
+				auto [l, t] = ref.LeftTop(x, y);
+				if (l < cam.viewRight && l + ref.tileWidth > cam.viewLeft && t < cam.viewBottom && t + ref.tileHeight > cam.viewTop) {
+					b.emplace_back(x, y);
+				}
+			}
+		}
+		std::sort(b.begin(), b.end(), [&](auto const& p, auto const& q) { return ref.Before(p, q); });
+
+		// non orthogonal: Commit's row / column range must cover every visible tile
+		bool covered = map.orientation == Orientations::Orthogonal || std::all_of(b.begin(), b.end(), [&](auto const& p) {
+			return p.first >= cam.columnFrom && p.first < cam.columnTo && p.second >= cam.rowFrom && p.second < cam.rowTo;
+		});
+
+		std::string name;
+		switch (map.orientation) {
+		case Orientations::Orthogonal: name = xx::ToString("orthogonal render order ", (int)map.renderOrder); break;
+		case Orientations::Isometric: name = "isometric"; break;
+		default: name = xx::ToString(map.orientation == Orientations::Staggered ? "staggered" : "hexagonal"
+			, " axis ", ref.staggerX ? "x" : "y", " index ", ref.staggerEven ? "even" : "odd");
+		}
+		auto& s = stats[name];
+		++s.first;
+		if (a != b || !covered) {
+			if (!s.second) {
+				xx::CoutN("mismatch: ", std::string_view(name), " round = ", round, " map = ", map.width, " x ", map.height
+					, " tile = ", map.tileWidth, " x ", map.tileHeight, " side = ", map.tileSideLength
+					, " visible tiles = ", a.size(), " expected = ", b.size(), " covered = ", covered);
+			}
+			++s.second;
+			++numFails;
+		}
+	}
+	for (auto& [name, s] : stats) {
+		xx::CoutN(std::string_view(name), ": rounds = ", s.first, " fails = ", s.second);
+	}
+	return numFails ? 1 : 0;
+}
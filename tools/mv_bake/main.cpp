@@ -0,0 +1,68 @@
+﻿#include "mv_bake.h"
+
+// usage: tools_mv_bake outPath name=file.xxmv [name=file.xxmv ...] [-atlas 2048] [-padding 2] [-notrim] [-premultiply] [-threads 0]
+//        tools_mv_bake -reheader in.xxmv [out.xxmv]	( rewrite with the "xxmv" + version header. no out: overwrite in )
+static void PrintUsage() {
+	xx::CoutN("usage: tools_mv_bake outPath name=file.xxmv [name=file.xxmv ...] [-atlas 2048] [-padding 2] [-notrim] [-premultiply] [-threads 0]");
+	xx::CoutN("       tools_mv_bake -reheader in.xxmv [out.xxmv]");
+}
+
+int main(int argc, char** argv) {
+	if (argc >= 3 && std::string_view(argv[1]) == "-reheader") {
+		xx::Data d;
+		if (int r = xx::ReadAllBytes(argv[2], d)) {
+			xx::CoutN("read file failed. r = ", r, " fn = ", std::string_view(argv[2]));
+			return 1;
+		}
+		xx::Mv mv;
+		if (int r = mv.LoadView(d)) {
+			xx::CoutN("bad xxmv file. r = ", r, " fn = ", std::string_view(argv[2]));
+			return 1;
+		}
+		xx::Data o;
+		mv.WriteTo(o);
+		auto outFn = argc > 3 ? argv[3] : argv[2];
+		if (int r = xx::WriteAllBytes(outFn, o)) {
+			xx::CoutN("write file failed. r = ", r, " fn = ", std::string_view(outFn));
+			return 1;
+		}
+		xx::CoutN("done. frames = ", mv.count);
+		return 0;
+	}
+	if (argc < 3) {
+		PrintUsage();
+		return 1;
+	}
+	std::string outPath = argv[1];
+	std::vector<std::pair<std::string, std::string>> clips;
+	xx::MvBakeOptions opts;
+	for (int i = 2; i < argc; ++i) {
+		std::string_view a = argv[i];
+		if (a == "-notrim") opts.trim = false;
+		else if (a == "-premultiply") opts.premultiply = true;
+		else if ((a == "-atlas" || a == "-padding" || a == "-threads") && i + 1 < argc) {
+			auto v = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+			if (a == "-atlas") opts.atlasSize = v;
+			else if (a == "-padding") opts.padding = v;
+			else opts.numThreads = v;
+		}
+		else if (auto p = a.find('='); p != a.npos && p) clips.emplace_back(a.substr(0, p), a.substr(p + 1));
+		else {
+			xx::CoutN("bad arg: ", a);
+			return 1;
+		}
+	}
+	if (clips.empty()) {
+		xx::CoutN("no name=file.xxmv given");
+		PrintUsage();
+		return 1;
+	}
+	try {
+		auto n = xx::MvBake(clips, outPath, opts);
+		xx::CoutN("done. pages = ", n);
+	} catch (std::exception const& e) {
+		xx::CoutN(std::string_view(e.what()));
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,237 @@
+﻿#include "mv_bake.h"
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+namespace xx {
+
+	struct MvBakeClip {
+		std::string name, fn;
+		uint32_t count{};			// frame count
+		uint32_t x0{}, y0{};		// trim offset in original frame
+		uint32_t w{}, h{};			// frame size after trim
+		XY anchor{ 0.5f, 0.5f };	// original center in trimmed frame
+		std::string error;
+	};
+
+	struct MvBakePos {
+		uint32_t page, x, y;
+	};
+
+	static int MvBakeLoad(MvBakeClip& c, Mv& mv) {
+		xx::Data d;
+		if (int r = xx::ReadAllBytes(c.fn, d)) {
+			c.error = xx::ToString("read file failed. r = ", r, ", fn = ", c.fn);
+			return __LINE__;
+		}
+		if (int r = mv.Load(std::move(d))) {
+			c.error = xx::ToString("bad xxmv file. r = ", r, ", fn = ", c.fn);
+			return __LINE__;
+		}
+		mv.decodeThreads = 1;	// already parallel by clips
+		return 0;
+	}
+
+	// pass 1: frame count & union of non transparent area. no frame is kept
+	static void MvBakeScan(MvBakeClip& c, MvBakeOptions const& opts) {
+		Mv mv;
+		if (MvBakeLoad(c, mv)) return;
+		c.count = mv.count;
+		uint32_t x0 = 0, y0 = 0, x1 = mv.width, y1 = mv.height;
+		if (opts.trim) {
+			x0 = mv.width;
+			y0 = mv.height;
+			x1 = y1 = 0;
+			if (int r = mv.ForeachFrame(MakeRgbaHandler([&](int const& frameIndex, uint32_t const& w, uint32_t const& h, uint8_t const* const& rgba)->int {
+				for (uint32_t y = 0; y < h; ++y) {
+					auto row = rgba + (size_t)w * 4 * y;
+					uint32_t l = 0, e = w;
+					while (l < w && !row[l * 4 + 3]) ++l;
+					if (l == w) continue;
+					while (!row[(e - 1) * 4 + 3]) --e;
+					x0 = std::min(x0, l);
+					x1 = std::max(x1, e);
+					y0 = std::min(y0, y);
+					y1 = std::max(y1, y + 1);
+				}
+				return 0;
+			}, opts.premultiply))) {
+				c.error = xx::ToString("decode failed. r = ", r, ", fn = ", c.fn);
+				return;
+			}
+			if (x1 <= x0) {	// fully transparent
+				x0 = y0 = 0;
+				x1 = y1 = 1;
+			}
+		}
+		c.x0 = x0;
+		c.y0 = y0;
+		c.w = x1 - x0;
+		c.h = y1 - y0;
+		c.anchor = { (mv.width * 0.5f - x0) / c.w, (y1 - mv.height * 0.5f) / c.h };	// anchor's y is bottom up
+	}
+
+	// pass 2: decode again, crop every frame straight into its page. clips never share pixels, so pages need no lock
+	static void MvBakeBlit(MvBakeClip& c, std::vector<MvBakePos> const& poss, std::vector<std::vector<uint8_t>>& pixels
+		, std::vector<std::pair<uint32_t, uint32_t>> const& pageSizes, MvBakeOptions const& opts) {
+		Mv mv;
+		if (MvBakeLoad(c, mv)) return;
+		if (mv.count != c.count) {
+			c.error = xx::ToString("file changed while baking. fn = ", c.fn);
+			return;
+		}
+		if (int r = mv.ForeachFrame(MakeRgbaHandler([&](int const& frameIndex, uint32_t const& w, uint32_t const& h, uint8_t const* const& rgba)->int {
+			auto& pos = poss[frameIndex];
+			auto pw = pageSizes[pos.page].first;
+			auto dst = pixels[pos.page].data();
+			for (uint32_t j = 0; j < c.h; ++j) {
+				memcpy(dst + ((size_t)pw * (pos.y + j) + pos.x) * 4, rgba + ((size_t)w * (c.y0 + j) + c.x0) * 4, (size_t)c.w * 4);
+			}
+			return 0;
+		}, opts.premultiply))) {
+			c.error = xx::ToString("decode failed. r = ", r, ", fn = ", c.fn);
+		}
+	}
+
+	static void MvBakeCheck(std::vector<MvBakeClip> const& cs) {
+		for (auto& c : cs) {
+			if (!c.error.empty()) throw std::logic_error(xx::ToString("MvBake error: clip = ", c.name, ", ", c.error));
+		}
+	}
+
+	size_t MvBake(std::vector<std::pair<std::string, std::string>> const& clips, std::string const& outPath, MvBakeOptions const& opts) {
+		if (clips.empty()) throw std::logic_error("MvBake error: no clips.");
+		auto numThreads = opts.numThreads ? opts.numThreads : std::max(1u, std::thread::hardware_concurrency());
+
+		// scan in parallel
+		std::vector<MvBakeClip> cs(clips.size());
+		{
+			xx::ThreadPool<> tp((int)std::min(numThreads, clips.size()));
+			for (size_t i = 0; i < clips.size(); ++i) {
+				cs[i].name = clips[i].first;
+				cs[i].fn = clips[i].second;
+				tp.Add([&c = cs[i], &opts] {
+					MvBakeScan(c, opts);
+				});
+			}
+		}
+		MvBakeCheck(cs);
+		for (auto& c : cs) {
+			if (c.w > opts.atlasSize || c.h > opts.atlasSize) throw std::logic_error(xx::ToString("MvBake error: clip = ", c.name, " frame size > atlasSize"));
+		}
+
+		// shelf pack. high clips first, frames keep order
+		std::vector<size_t> order(cs.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](auto const& a, auto const& b) {
+			return cs[a].h > cs[b].h;
+		});
+		std::vector<std::vector<MvBakePos>> poss(cs.size());
+		std::vector<std::pair<uint32_t, uint32_t>> pageSizes(1);
+		uint32_t x = 0, y = 0, shelfH = 0;
+		for (auto& ci : order) {
+			auto& c = cs[ci];
+			for (uint32_t i = 0; i < c.count; ++i) {
+				if (x + c.w > opts.atlasSize) {
+					x = 0;
+					y += shelfH + opts.padding;
+					shelfH = 0;
+				}
+				if (y + c.h > opts.atlasSize) {
+					pageSizes.emplace_back();
+					x = y = shelfH = 0;
+				}
+				auto& ps = pageSizes.back();
+				poss[ci].push_back({ (uint32_t)pageSizes.size() - 1, x, y });
+				ps.first = std::max(ps.first, x + c.w);
+				ps.second = std::max(ps.second, y + c.h);
+				x += c.w + opts.padding;
+				shelfH = std::max(shelfH, c.h);
+			}
+		}
+
+		// fill frames
+		std::vector<std::vector<uint8_t>> pixels(pageSizes.size());
+		std::vector<TP> tps(pageSizes.size());
+		for (size_t p = 0; p < pageSizes.size(); ++p) {
+			pixels[p].resize((size_t)pageSizes[p].first * pageSizes[p].second * 4);
+			tps[p].premultiplyAlpha = opts.premultiply;
+			tps[p].realTextureFileName = outPath + "_" + std::to_string(p) + ".png";
+			tps[p].textureFileName = std::filesystem::path(tps[p].realTextureFileName).filename().string();	// .tpb sits next to the png
+		}
+		for (auto& ci : order) {
+			auto& c = cs[ci];
+			for (uint32_t i = 0; i < c.count; ++i) {
+				auto& pos = poss[ci][i];
+				auto&& f = *tps[pos.page].frames.emplace_back().Emplace();
+				f.key = c.name + "_" + std::to_string(i);
+				f.anchor = c.anchor;
+				f.spriteSize = f.spriteSourceSize = { (float)c.w, (float)c.h };
+				f.textureRect = { (float)pos.x, (float)pos.y, (float)c.w, (float)c.h };
+			}
+		}
+
+		// decode again & blit in parallel
+		{
+			xx::ThreadPool<> tp((int)std::min(numThreads, clips.size()));
+			for (size_t i = 0; i < cs.size(); ++i) {
+				tp.Add([&, i] {
+					MvBakeBlit(cs[i], poss[i], pixels, pageSizes, opts);
+				});
+			}
+		}
+		MvBakeCheck(cs);
+
+		// write pages in parallel
+		std::vector<std::string> errors(pageSizes.size());
+		{
+			xx::ThreadPool<> tp((int)std::min(numThreads, pageSizes.size()));
+			for (size_t p = 0; p < pageSizes.size(); ++p) {
+				tp.Add([&, p] {
+					auto& [w, h] = pageSizes[p];
+					if (!stbi_write_png(tps[p].realTextureFileName.c_str(), (int)w, (int)h, 4, pixels[p].data(), (int)w * 4)) {
+						errors[p] = "write png failed. fn = " + tps[p].realTextureFileName;
+						return;
+					}
+					xx::Data d;
+					tps[p].WriteTo(d);
+					auto fn = outPath + "_" + std::to_string(p) + ".tpb";
+					if (int r = xx::WriteAllBytes(fn, d)) {
+						errors[p] = xx::ToString("write tpb failed. r = ", r, ", fn = ", fn);
+					}
+				});
+			}
+		}
+		for (auto& e : errors) {
+			if (!e.empty()) throw std::logic_error("MvBake error: " + e);
+		}
+		return pageSizes.size();
+	}
+
+	/*
+	offline ( tools_mv_bake, no gpu ):
+
+		tools_mv_bake res/vfx st_k100=res/st_k100.xxmv boom=res/boom.xxmv
+
+	or in code ( #include "mv_bake.h" ):
+
+		auto n = xx::MvBake({ { "st_k100", "res/st_k100.xxmv" }, { "boom", "res/boom.xxmv" } }, "res/vfx");
+		// output: res/vfx_0.png res/vfx_0.tpb ... res/vfx_( n - 1 ).*
+
+	runtime:
+
+		std::vector<xx::Shared<xx::Frame>> fs;
+		for (size_t i = 0; i < n; ++i) {
+			xx::TP tp;
+			tp.Fill(xx::ToString("res/vfx_", i, ".tpb"), false);
+			tp.GetToByPrefix(fs, "st_k100_");	// a clip can cross pages. frames keep order
+		}
+		xx::Anim anim;
+		anim.afs = xx::MakeAnimFrames(fs, 1.f / 60);
+		xx::Sprite spr;
+		spr.SetFrame(fs[0]);
+		...
+		if (anim.Update(xx::engine.delta)) {
+			spr.SetFrame(anim.GetCurrentAnimFrame().frame);	// same texture in page: no upload, no draw call break
+		}
+	*/
+}
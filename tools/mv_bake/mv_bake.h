@@ -0,0 +1,18 @@
+﻿#pragma once
+#include "xx2d.h"
+
+namespace xx {
+
+	struct MvBakeOptions {
+		uint32_t atlasSize = 2048;	// page max width & height
+		uint32_t padding = 2;		// pixels between frames
+		bool trim = true;			// crop all frames of a clip to union of non transparent area. anchor keep original center
+		bool premultiply = false;
+		size_t numThreads = 0;		// decode clips & write pages in parallel. 0: hardware_concurrency
+	};
+
+	// offline ( no gpu ): decode clips { name, .xxmv path }, shelf pack all frames into rgba pages,
+	// write outPath_N.png + outPath_N.tpb. frame key: name + '_' + index. return page count. throw std::logic_error when failed ( or clips is empty )
+	// every clip is decoded twice: scan trim bounds, then crop each frame straight into its page. peak memory: pages + 1 frame per thread
+	size_t MvBake(std::vector<std::pair<std::string, std::string>> const& clips, std::string const& outPath, MvBakeOptions const& opts = {});
+}
@@ -0,0 +1,35 @@
+﻿#include "xx2d.h"
+
+// texture packer's cocos 3.x .plist -> precompiled .tpb ( sorted frames, polygon data & flip y applied ). offline, no window / gl context
+// usage: tools_tp_compile file.plist [file.plist ...]	( plain or zstd packed. writes file.tpb next to each plist. texture file name is kept as written in plist )
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		xx::CoutN("usage: tools_tp_compile file.plist [file.plist ...]");
+		return 1;
+	}
+	xx::engine.Init();
+	for (int i = 1; i < argc; ++i) {
+		std::filesystem::path fn(argv[i]);
+		xx::Data d;
+		try {
+			d = xx::engine.LoadFileDataWithFullPath(argv[i]);	// unpack zstd ones
+		} catch (std::exception const& e) {
+			xx::CoutN(std::string_view(e.what()));
+			return 1;
+		}
+		xx::TP tp;
+		if (int r = tp.Fill(d, ""sv)) {
+			xx::CoutN("parse plist failed ( not a cocos 3.x plist? ). r = ", r, " fn = ", std::string_view(argv[i]));
+			return 1;
+		}
+		xx::Data o;
+		tp.WriteTo(o);
+		auto outFn = fn.replace_extension(".tpb");
+		if (int r = xx::WriteAllBytes(outFn, o)) {
+			xx::CoutN("write file failed. r = ", r, " fn = ", outFn.string());
+			return 1;
+		}
+		xx::CoutN(outFn.string(), " frames = ", tp.frames.size(), " texture = ", tp.textureFileName);
+	}
+	return 0;
+}
@@ -25,8 +25,10 @@
 #include <algorithm>
 #include <iostream>
 #include <thread>
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <latch>
 #include <fstream>
 #include <filesystem>
 #if __has_include(<span>)
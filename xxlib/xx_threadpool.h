@@ -70,6 +70,84 @@ namespace xx {
 
 
 
+    // 单生产者 单消费者 有界环形队列. lock free, no alloc. T should be small & trivially copyable
+    // consumer: Peek -> handle -> Pop, so WaitEmpty returns after the last item was handled
+    template<typename T, size_t cap>
+    struct SpscRing {
+        static_assert(cap && (cap & (cap - 1)) == 0, "cap must be power of 2");
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        std::array<T, cap> buf;
+        alignas(64) std::atomic<uint32_t> head{};    // consumer's read pos
+        uint32_t tailCache{};                       // consumer's copy of tail. reduce cache line ping-pong
+        alignas(64) std::atomic<uint32_t> tail{};    // producer's write pos
+        uint32_t headCache{};                       // producer's copy of head
+        std::atomic<bool> consumerWaiting{}, producerWaiting{};  // notify ( syscall ) only when the other side sleeping
+
+        // producer. return false: full
+        bool Push(T const& v) {
+            auto t = tail.load(std::memory_order_relaxed);
+            if (t - headCache == cap) {
+                headCache = head.load(std::memory_order_acquire);
+                if (t - headCache == cap) return false;
+            }
+            buf[t & (cap - 1)] = v;
+            tail.store(t + 1, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (consumerWaiting.load(std::memory_order_relaxed) && consumerWaiting.exchange(false, std::memory_order_relaxed)) {
+                tail.notify_one();
+            }
+            return true;
+        }
+
+        // producer. block until consumer handled all items
+        void WaitEmpty() {
+            while (true) {
+                auto h = head.load(std::memory_order_acquire);
+                if (h == tail.load(std::memory_order_relaxed)) return;
+                producerWaiting.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (h == head.load(std::memory_order_relaxed)) {
+                    head.wait(h, std::memory_order_acquire);
+                }
+                producerWaiting.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        // consumer. return nullptr: empty
+        T const* Peek() {
+            auto h = head.load(std::memory_order_relaxed);
+            if (h == tailCache) {
+                tailCache = tail.load(std::memory_order_acquire);
+                if (h == tailCache) return nullptr;
+            }
+            return &buf[h & (cap - 1)];
+        }
+
+        // consumer. release the item returned by Peek
+        void Pop() {
+            head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (producerWaiting.load(std::memory_order_relaxed) && producerWaiting.exchange(false, std::memory_order_relaxed)) {
+                head.notify_one();
+            }
+        }
+
+        // consumer. block until not empty
+        void WaitPush() {
+            auto h = head.load(std::memory_order_relaxed);
+            consumerWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (h == tail.load(std::memory_order_relaxed)) {
+                tail.wait(h, std::memory_order_acquire);
+            }
+            consumerWaiting.store(false, std::memory_order_relaxed);
+        }
+    };
+
+
+
+
     // SFINAE test 检查目标类型是否带有 operator() 函数
     template <typename T>
     class has_OperatorParentheses {